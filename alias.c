@@ -98,6 +98,11 @@ static bool print_alias(const wchar_t *name, const alias_T *alias, bool prefix);
 /* Hashtable mapping alias names (wide strings) to alias_T's. */
 hashtable_T aliases;
 
+/* This counter is incremented each time an alias is defined or removed.
+ * Parse trees that were built with alias substitution enabled are valid only
+ * while this counter is unchanged. */
+unsigned long alias_generation = 0;
+
 
 /* Initializes the alias module. */
 void init_alias(void)
@@ -150,6 +155,7 @@ void define_alias(
     alias->value[namelen + valuelen + 1] = L'\0';
 
     vfreealias(ht_set(&aliases, alias->value + valuelen + 1, alias));
+    alias_generation++;
 }
 
 /* Removes the alias definition with the specified name if any.
@@ -161,6 +167,7 @@ bool remove_alias(const wchar_t *name)
 
     if (alias != NULL) {
         free_alias(alias);
+        alias_generation++;
         return true;
     } else {
         return false;
@@ -171,12 +178,13 @@ bool remove_alias(const wchar_t *name)
 void remove_all_aliases(void)
 {
     ht_clear(&aliases, vfreealias);
+    alias_generation++;
 }
 
 /* Returns the value of the specified alias (or null if there is no such). */
 const wchar_t *get_alias_value(const wchar_t *aliasname)
 {
-    const alias_T *alias = ht_get(&aliases, aliasname).value;
+    const alias_T *alias = ht_getwcs(&aliases, aliasname).value;
 
     if (alias != NULL)
         return alias->value;
@@ -329,7 +337,7 @@ bool substitute_alias_range(xwcsbuf_T *restrict buf, size_t i, size_t j,
     /* get alias definition */
     wchar_t savechar = buf->contents[j];
     buf->contents[j] = L'\0';
-    alias = ht_get(&aliases, buf->contents + i).value;
+    alias = ht_getwcs(&aliases, buf->contents + i).value;
     buf->contents[j] = savechar;
 
     /* check if we should do substitution */
@@ -396,7 +404,7 @@ bool print_alias(const wchar_t *name, const alias_T *alias, bool prefix)
  */
 bool print_alias_if_defined(const wchar_t *aliasname, bool user_friendly)
 {
-    const alias_T *alias = ht_get(&aliases, aliasname).value;
+    const alias_T *alias = ht_getwcs(&aliases, aliasname).value;
 
     if (alias == NULL || alias->isglobal)
         return false;
@@ -495,7 +503,7 @@ int alias_builtin(int argc, void **argv)
                 define_alias(arg, nameend, global);
             } else if (nameend != arg && *nameend == L'\0') {
                 /* print alias */
-                const alias_T *alias = ht_get(&aliases, arg).value;
+                const alias_T *alias = ht_getwcs(&aliases, arg).value;
                 if (alias != NULL) {
                     if (!print_alias(arg, alias, prefix))
                         break;
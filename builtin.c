@@ -42,6 +42,9 @@
 #include "variable.h"
 #include "xfnmatch.h"
 #include "yash.h"
+#if YASH_ENABLE_CAT
+# include "builtins/cat.h"
+#endif
 #if YASH_ENABLE_PRINTF
 # include "builtins/printf.h"
 #endif
@@ -165,6 +168,8 @@ void init_builtin(void)
             help_option);
     DEFBUILTIN("wait", wait_builtin, BI_MANDATORY, wait_help, wait_syntax,
             help_option);
+    DEFBUILTIN("waitany", waitany_builtin, BI_EXTENSION, waitany_help,
+            waitany_syntax, waitany_options);
     DEFBUILTIN("disown", disown_builtin, BI_ELECTIVE, disown_help,
             disown_syntax, all_help_options);
 
@@ -188,6 +193,8 @@ void init_builtin(void)
     DEFBUILTIN(".", dot_builtin, BI_SPECIAL, dot_help, dot_syntax, dot_options);
     DEFBUILTIN("exec", exec_builtin, BI_SPECIAL, exec_help, exec_syntax,
             exec_options);
+    DEFBUILTIN("coproc", coproc_builtin, BI_EXTENSION, coproc_help,
+            coproc_syntax, coproc_options);
     DEFBUILTIN("command", command_builtin, BI_MANDATORY, command_help,
             command_syntax, command_options);
     DEFBUILTIN("type", command_builtin, BI_MANDATORY, type_help, type_syntax,
@@ -215,6 +222,12 @@ void init_builtin(void)
             printf_syntax, help_option);
 #endif
 
+    /* defined in "builtins/cat.c" */
+#if YASH_ENABLE_CAT
+    DEFBUILTIN("cat", cat_builtin, BI_SUBSTITUTIVE, cat_help, cat_syntax,
+            cat_options);
+#endif
+
     /* defined in "builtins/test.c" */
 #if YASH_ENABLE_TEST
     DEFBUILTIN("test", test_builtin, BI_SUBSTITUTIVE, test_help, test_syntax,
@@ -241,7 +254,7 @@ void init_builtin(void)
 /* Returns the built-in command of the specified name or NULL if not found. */
 const builtin_T *get_builtin(const char *name)
 {
-    return ht_get(&builtins, name).value;
+    return ht_getstr(&builtins, name).value;
 }
 
 /* Prints the following error message and returns Exit_ERROR:
@@ -0,0 +1,337 @@
+/* Yash: yet another shell */
+/* cat.c: cat builtin */
+/* (C) 2024 magicant */
+
+/* This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#include "../common.h"
+#include "cat.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#if HAVE_GETTEXT
+# include <libintl.h>
+#endif
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#if HAVE_SENDFILE
+# include <sys/sendfile.h>
+#endif
+#include <unistd.h>
+#include <wchar.h>
+#include "../builtin.h"
+#include "../exec.h"
+#include "../job.h"
+#include "../redir.h"
+#include "../sig.h"
+#include "../strbuf.h"
+#include "../util.h"
+
+#if HAVE_COPY_FILE_RANGE && !defined(copy_file_range)
+extern ssize_t copy_file_range(int infd, off_t *inoff, int outfd,
+        off_t *outoff, size_t len, unsigned int flags);
+#endif
+#if HAVE_SPLICE && !defined(splice)
+extern ssize_t splice(int infd, off_t *inoff, int outfd, off_t *outoff,
+        size_t len, unsigned int flags);
+#endif
+
+#define IN_KERNEL_COPY (HAVE_COPY_FILE_RANGE || HAVE_SENDFILE || HAVE_SPLICE)
+
+/* the maximum number of bytes transferred by one in-kernel copy */
+#define CAT_CHUNK_SIZE (1 << 30)
+/* the size of the buffer used by the read/write fallback */
+#define CAT_BUFFER_SIZE (1 << 16)
+
+
+/* result of a copy */
+typedef enum copyresult_T {
+    CR_DONE,        // the whole contents have been copied
+    CR_FALLBACK,    // the method is not applicable; try another one
+    CR_ERROR,       // an error occurred and has been reported
+    CR_INTERRUPTED, // the copy was interrupted by SIGINT
+} copyresult_T;
+
+#if IN_KERNEL_COPY
+typedef enum copymethod_T {
+    CM_COPY_FILE_RANGE, CM_SENDFILE, CM_SPLICE,
+} copymethod_T;
+#endif
+
+static int cat_file(const wchar_t *name)
+    __attribute__((nonnull));
+static copyresult_T cat_fd(int infd, const char *name)
+    __attribute__((nonnull));
+#if IN_KERNEL_COPY
+static copyresult_T copy_in_kernel(int infd, copymethod_T method);
+#endif
+static copyresult_T copy_by_read_write(int infd, bool seekable,
+        const char *name)
+    __attribute__((nonnull));
+static copyresult_T wait_for_cat_input(int infd);
+
+const struct xgetopt_T cat_options[] = {
+    { L'u', NULL, OPTARG_NONE, true, NULL, },
+#if YASH_ENABLE_HELP
+    { L'-', L"help", OPTARG_NONE, false, NULL, },
+#endif
+    { L'\0', NULL, 0, false, NULL, },
+};
+
+/* The "cat" built-in, which accepts the following option:
+ *  -u: don't buffer output (ignored because output is never buffered) */
+int cat_builtin(int argc, void **argv)
+{
+    const struct xgetopt_T *opt;
+    xoptind = 0;
+    while ((opt = xgetopt(argv, cat_options, XGETOPT_POSIX)) != NULL) {
+        switch (opt->shortopt) {
+            case L'u':
+                break;
+#if YASH_ENABLE_HELP
+            case L'-':
+                return print_builtin_help(ARGV(0));
+#endif
+            default:
+                return Exit_ERROR;
+        }
+    }
+
+    /* anything printed by other built-ins must precede our output */
+    if (fflush(stdout) != 0) {
+        xerror(errno, Ngt("cannot print to the standard output"));
+        return Exit_FAILURE;
+    }
+
+    if (xoptind == argc)
+        return cat_file(L"-");
+
+    int exitstatus = Exit_SUCCESS;
+    for (; xoptind < argc; xoptind++) {
+        int status = cat_file(ARGV(xoptind));
+        if (status != Exit_SUCCESS) {
+            exitstatus = status;
+            if (status != Exit_FAILURE)
+                break;
+        }
+    }
+    return exitstatus;
+}
+
+/* Copies the contents of the named file to the standard output.
+ * If `name' is "-", the standard input is copied.
+ * Returns the exit status for the built-in. */
+int cat_file(const wchar_t *name)
+{
+    int fd;
+    char *mbsname;
+
+    if (wcscmp(name, L"-") == 0) {
+        fd = STDIN_FILENO;
+        mbsname = NULL;
+    } else {
+        mbsname = malloc_wcstombs(name);
+        if (mbsname == NULL) {
+            xerror(EILSEQ, Ngt("unexpected error"));
+            return Exit_FAILURE;
+        }
+        fd = open(mbsname, O_RDONLY);
+        if (fd < 0) {
+            xerror(errno, Ngt("cannot open file `%s'"), mbsname);
+            free(mbsname);
+            return Exit_FAILURE;
+        }
+    }
+
+    copyresult_T result = cat_fd(fd, (mbsname != NULL) ? mbsname : "-");
+
+    if (fd != STDIN_FILENO)
+        xclose(fd);
+    free(mbsname);
+
+    switch (result) {
+        case CR_DONE:
+            return Exit_SUCCESS;
+        case CR_INTERRUPTED:
+            return SIGINT + TERMSIGOFFSET;
+        case CR_FALLBACK:
+            assert(false);
+        case CR_ERROR:
+            break;
+    }
+    return Exit_FAILURE;
+}
+
+/* Copies the contents of file descriptor `infd' to the standard output.
+ * `name' is the file name used in error messages.
+ * The data are transferred without being copied to user space if possible:
+ * `copy_file_range' and `sendfile' are tried for a non-empty regular file and
+ * `splice' for a pipe. If none of them applies, the data are copied by `read'
+ * and `write'. Since the in-kernel copies advance the file offset, the
+ * fallback continues from where the failed one stopped. */
+copyresult_T cat_fd(int infd, const char *name)
+{
+    struct stat st;
+    bool regular = false, fifo = false;
+
+    if (fstat(infd, &st) >= 0) {
+        regular = S_ISREG(st.st_mode);
+        fifo = S_ISFIFO(st.st_mode);
+    }
+
+    copyresult_T result = CR_FALLBACK;
+    /* A regular file with the size of zero may be a pseudo-file whose contents
+     * are generated on read, which the in-kernel copies cannot handle. */
+    if (regular && st.st_size > 0) {
+#if HAVE_COPY_FILE_RANGE
+        result = copy_in_kernel(infd, CM_COPY_FILE_RANGE);
+#endif
+#if HAVE_SENDFILE
+        if (result == CR_FALLBACK)
+            result = copy_in_kernel(infd, CM_SENDFILE);
+#endif
+    } else if (fifo) {
+#if HAVE_SPLICE
+        result = copy_in_kernel(infd, CM_SPLICE);
+#endif
+    }
+    if (result == CR_FALLBACK)
+        result = copy_by_read_write(infd, regular, name);
+    assert(result != CR_FALLBACK);
+    return result;
+}
+
+#if IN_KERNEL_COPY
+
+/* Copies data from `infd' to the standard output with the system call
+ * specified by `method'.
+ * Returns CR_FALLBACK if the system call fails or does not transfer any data
+ * at first, in which case the caller should copy the rest in another way.
+ * Errors are not reported here; the fallback will report them if they are
+ * real. */
+copyresult_T copy_in_kernel(int infd, copymethod_T method)
+{
+    bool copied = false;
+
+    for (;;) {
+        ssize_t count;
+
+        switch (method) {
+#if HAVE_COPY_FILE_RANGE
+            case CM_COPY_FILE_RANGE:
+                count = copy_file_range(
+                        infd, NULL, STDOUT_FILENO, NULL, CAT_CHUNK_SIZE, 0);
+                break;
+#endif
+#if HAVE_SENDFILE
+            case CM_SENDFILE:
+                count = sendfile(STDOUT_FILENO, infd, NULL, CAT_CHUNK_SIZE);
+                break;
+#endif
+#if HAVE_SPLICE
+            case CM_SPLICE:;
+                copyresult_T result = wait_for_cat_input(infd);
+                if (result != CR_DONE)
+                    return result;
+                count = splice(
+                        infd, NULL, STDOUT_FILENO, NULL, CAT_CHUNK_SIZE, 0);
+                break;
+#endif
+            default:
+                assert(false);
+                return CR_FALLBACK;
+        }
+
+        if (count < 0)
+            return CR_FALLBACK;
+        if (count == 0)
+            return copied ? CR_DONE : CR_FALLBACK;
+        copied = true;
+    }
+}
+
+#endif /* IN_KERNEL_COPY */
+
+/* Copies data from `infd' to the standard output by `read' and `write'.
+ * If `seekable' is false, the input is waited for before each `read' so that
+ * the copy can be interrupted. */
+copyresult_T copy_by_read_write(int infd, bool seekable, const char *name)
+{
+    char *buf = xmalloc(CAT_BUFFER_SIZE);
+    copyresult_T result;
+
+    for (;;) {
+        if (!seekable) {
+            result = wait_for_cat_input(infd);
+            if (result != CR_DONE)
+                break;
+        }
+
+        ssize_t count = read(infd, buf, CAT_BUFFER_SIZE);
+        if (count < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            xerror(errno, Ngt("cannot read file `%s'"), name);
+            result = CR_ERROR;
+            break;
+        }
+        if (count == 0) {
+            result = CR_DONE;
+            break;
+        }
+        if (!write_all(STDOUT_FILENO, buf, count)) {
+            xerror(errno, Ngt("cannot print to the standard output"));
+            result = CR_ERROR;
+            break;
+        }
+    }
+
+    free(buf);
+    return result;
+}
+
+/* Waits for `infd' to be readable, handling traps while waiting.
+ * Returns CR_DONE if ready, CR_INTERRUPTED if interrupted, or CR_ERROR on
+ * error. */
+copyresult_T wait_for_cat_input(int infd)
+{
+    switch (wait_for_input(infd, true, -1)) {
+        case W_READY:
+            return CR_DONE;
+        case W_INTERRUPTED:
+            return CR_INTERRUPTED;
+        case W_TIMED_OUT:
+            assert(false);
+        case W_ERROR:
+            break;
+    }
+    return CR_ERROR;
+}
+
+#if YASH_ENABLE_HELP
+const char cat_help[] = Ngt(
+"concatenate files to the standard output"
+);
+const char cat_syntax[] = Ngt(
+"\tcat [-u] [file...]\n"
+);
+#endif
+
+
+/* vim: set ts=8 sts=4 sw=4 et tw=80: */
@@ -30,6 +30,9 @@
 # include <paths.h>
 #endif
 #include <signal.h>
+#if HAVE_POSIX_SPAWN
+# include <spawn.h>
+#endif
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -41,6 +44,7 @@
 #include "alias.h"
 #include "builtin.h"
 #include "expand.h"
+#include "hashtable.h"
 #if YASH_ENABLE_HISTORY
 # include "history.h"
 #endif
@@ -65,6 +69,10 @@
 # include "lineedit/lineedit.h"
 #endif
 
+#if HAVE_PIPE2 && !defined(pipe2)
+extern int pipe2(int fds[2], int flags);
+#endif
+
 
 /* type of command execution */
 typedef enum {
@@ -115,6 +123,15 @@ typedef struct commandinfo_T {
 #define ci_builtin  value.builtin
 #define ci_function value.function
 
+/* result of the search for built-ins and functions cached in a simple command
+ * (`c_cmdcache') */
+struct cmdcache_T {
+    unsigned long funcgen;   /* `function_generation' when cached */
+    bool posix;              /* `posixly_correct' when cached */
+    commandinfo_T info;      /* result of the search */
+    wchar_t name[];          /* name of the command searched for */
+};
+
 /* result of `fork_and_wait' */
 typedef struct fork_and_wait_T {
     pid_t cpid;       /* child process ID */
@@ -156,21 +173,29 @@ static inline void next_pipe(pipeinfo_T *pi, bool next)
     __attribute__((nonnull));
 static inline void connect_pipes(pipeinfo_T *pi)
     __attribute__((nonnull));
+#if HAVE_POSIX_SPAWN
+static pid_t spawn_command_in_pipeline(command_T *c, const pipeinfo_T *pi)
+    __attribute__((nonnull));
+#endif
 
 static void exec_one_command(command_T *c, bool finally_exit)
     __attribute__((nonnull));
-static void exec_simple_command(const command_T *c, bool finally_exit)
+static void exec_simple_command(command_T *c, bool finally_exit)
     __attribute__((nonnull));
 static bool exec_simple_command_without_words(const command_T *c)
     __attribute__((nonnull,warn_unused_result));
 static bool exec_simple_command_with_words(
-        const command_T *c, int argc, void **argv, bool finally_exit)
+        command_T *c, int argc, void **argv, bool finally_exit)
     __attribute__((nonnull,warn_unused_result));
 static void print_xtrace(void *const *argv);
 static void search_command(
         const char *restrict name, const wchar_t *restrict wname,
         commandinfo_T *restrict ci, enum srchcmdtype_T type)
     __attribute__((nonnull));
+static void search_builtin_or_function_cached(command_T *restrict c,
+        const char *restrict name, const wchar_t *restrict wname,
+        commandinfo_T *restrict ci)
+    __attribute__((nonnull));
 static inline bool is_special_builtin(const char *cmdname)
     __attribute__((nonnull,pure));
 static bool command_not_found_handler(void *const *argv)
@@ -421,8 +446,16 @@ void exec_commands(command_T *const cs, exec_T type)
         if (is_last && short_circuit)
             goto exec_one_command; /* skip forking */
 
-        sigtype_T sigtype = (type == E_ASYNC) ? t_quitint : 0;
-        pid_t pid = fork_and_reset(pgid, type == E_NORMAL, sigtype);
+        pid_t pid = -1;
+#if HAVE_POSIX_SPAWN
+        if (type != E_ASYNC)
+            pid = spawn_command_in_pipeline(c, &pipe);
+        if (pid < 0)
+#endif
+        {
+            sigtype_T sigtype = (type == E_ASYNC) ? t_quitint : 0;
+            pid = fork_and_reset(pgid, type == E_NORMAL, sigtype);
+        }
         if (pid == 0) {
 exec_one_command: /* child process */
             free(job);
@@ -579,7 +612,15 @@ void next_pipe(pipeinfo_T *pi, bool next)
         xclose(pi->pi_tonextfds[PIPE_OUT]);
     pi->pi_fromprevfd = pi->pi_tonextfds[PIPE_IN];
     if (next) {
+        /* Where possible, the pipe is made close-on-exec so that a command
+         * started by `posix_spawn' needs no file action to close the unused
+         * ends. `dup2' clears the flag when the ends are moved to the standard
+         * input/output. */
+#if HAVE_PIPE2
+        if (pipe2(pi->pi_tonextfds, O_CLOEXEC) < 0)
+#else
         if (pipe(pi->pi_tonextfds) < 0)
+#endif
             goto fail;
 
         /* The pipe's FDs must not be 0 or 1, or they may be overridden by each
@@ -589,9 +630,9 @@ void next_pipe(pipeinfo_T *pi, bool next)
         int origout = pi->pi_tonextfds[PIPE_OUT];
         if (origin < 2 || origout < 2) {
             if (origin < 2)
-                pi->pi_tonextfds[PIPE_IN] = dup(origin);
+                pi->pi_tonextfds[PIPE_IN] = copy_as_cloexec_fd(origin, 2);
             if (origout < 2)
-                pi->pi_tonextfds[PIPE_OUT] = dup(origout);
+                pi->pi_tonextfds[PIPE_OUT] = copy_as_cloexec_fd(origout, 2);
             if (origin < 2)
                 xclose(origin);
             if (origout < 2)
@@ -630,6 +671,108 @@ void connect_pipes(pipeinfo_T *pi)
         xclose(pi->pi_tonextfds[PIPE_IN]);
 }
 
+#if HAVE_POSIX_SPAWN
+
+/* Starts the specified command of a pipeline by `posix_spawn' instead of
+ * forking the shell, which saves copying the shell's memory.
+ * This is done only if the forked child would immediately exec an external
+ * program without any observable effect in the shell: the command must be a
+ * simple command with literal words only, without assignments or redirections,
+ * naming an external program; and the shell must not be interactive, doing
+ * job control, or tracing commands.
+ * `pi' specifies the pipes to be connected to the command.
+ * Returns the process ID of the child, or -1 if the command was not started,
+ * in which case the caller should fork the shell to execute the command as
+ * usual. No error message is printed on failure since the forked child will
+ * report the error if any. */
+pid_t spawn_command_in_pipeline(command_T *c, const pipeinfo_T *pi)
+{
+    if (c->c_type != CT_SIMPLE || c->c_assigns != NULL || c->c_redirs != NULL)
+        return -1;
+    if (is_interactive_now || doing_job_control_now || shopt_xtrace)
+        return -1;
+
+    const sigset_t *sigmask = get_sigmask_for_exec();
+    if (sigmask == NULL)
+        return -1;
+
+    size_t argc = plcount(c->c_words);
+    if (argc == 0)
+        return -1;
+
+    pid_t pid = -1;
+    const wchar_t *wname = literal_field(c->c_words[0]);
+    char *args[argc + 1];
+    size_t i;
+    for (i = 0; i < argc; i++) {
+        const wchar_t *arg = (i == 0) ? wname : literal_field(c->c_words[i]);
+        if (arg == NULL || (args[i] = malloc_wcstombs(arg)) == NULL)
+            goto free_args;
+    }
+    args[argc] = NULL;
+
+    /* the command must not be a built-in or function */
+    commandinfo_T ci;
+    search_builtin_or_function_cached(c, args[0], wname, &ci);
+    if (ci.type != CT_NONE)
+        goto free_args;
+
+    char *path;
+    if (wcschr(wname, L'/') != NULL) {
+        if (!is_executable_regular(args[0]))
+            goto free_args;
+        path = xstrdup(args[0]);
+    } else {
+        /* a substitutive built-in would be executed instead */
+        if (get_builtin(args[0]) != NULL)
+            goto free_args;
+        path = get_command_path_uncached(args[0]);
+        if (path == NULL)
+            goto free_args;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    if (posix_spawn_file_actions_init(&actions) != 0)
+        goto free_path;
+    if (posix_spawnattr_init(&attr) != 0)
+        goto destroy_actions;
+
+    bool ok = true;
+    if (pi->pi_fromprevfd >= 0)
+        ok &= posix_spawn_file_actions_adddup2(
+                &actions, pi->pi_fromprevfd, STDIN_FILENO) == 0;
+    if (pi->pi_tonextfds[PIPE_OUT] >= 0)
+        ok &= posix_spawn_file_actions_adddup2(
+                &actions, pi->pi_tonextfds[PIPE_OUT], STDOUT_FILENO) == 0;
+#if !HAVE_PIPE2
+    if (pi->pi_fromprevfd >= 0)
+        ok &= posix_spawn_file_actions_addclose(
+                &actions, pi->pi_fromprevfd) == 0;
+    for (int j = 0; j < 2; j++)
+        if (pi->pi_tonextfds[j] >= 0)
+            ok &= posix_spawn_file_actions_addclose(
+                    &actions, pi->pi_tonextfds[j]) == 0;
+#endif
+    ok &= posix_spawnattr_setsigmask(&attr, sigmask) == 0;
+    ok &= posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK) == 0;
+
+    if (ok && posix_spawn(&pid, path, &actions, &attr, args, environ) != 0)
+        pid = -1;
+
+    posix_spawnattr_destroy(&attr);
+destroy_actions:
+    posix_spawn_file_actions_destroy(&actions);
+free_path:
+    free(path);
+free_args:
+    while (i > 0)
+        free(args[--i]);
+    return pid;
+}
+
+#endif /* HAVE_POSIX_SPAWN */
+
 /* Executes the command. */
 void exec_one_command(command_T *c, bool finally_exit)
 {
@@ -660,7 +803,7 @@ void exec_one_command(command_T *c, bool finally_exit)
 }
 
 /* Executes the simple command. */
-void exec_simple_command(const command_T *c, bool finally_exit)
+void exec_simple_command(command_T *c, bool finally_exit)
 {
     lastcmdsubstatus = Exit_SUCCESS;
 
@@ -736,7 +879,7 @@ bool exec_simple_command_without_words(const command_T *c)
  * process. However, this function still may return in some cases.
  * Returns true if the shell should exit. */
 bool exec_simple_command_with_words(
-        const command_T *c, int argc, void **argv, bool finally_exit)
+        command_T *c, int argc, void **argv, bool finally_exit)
 {
     assert(argc > 0);
 
@@ -758,7 +901,7 @@ bool exec_simple_command_with_words(
 
     /* check if the command is a special built-in or function */
     commandinfo_T cmdinfo;
-    search_command(argv0, argv[0], &cmdinfo, SCT_BUILTIN | SCT_FUNCTION);
+    search_builtin_or_function_cached(c, argv0, argv[0], &cmdinfo);
     special_builtin_executed = (cmdinfo.type == CT_SPECIALBUILTIN);
 
     /* open a temporary variable environment */
@@ -974,6 +1117,38 @@ void search_command(
     return;
 }
 
+/* Same as `search_command(name, wname, ci, SCT_BUILTIN | SCT_FUNCTION)', but
+ * the result is cached in the simple command `c' so that the next search for
+ * the same name in the same command can be skipped.
+ * The set of built-ins does not change while the shell is running, so the
+ * cache is valid until a function is defined or removed or the "posixly-
+ * correct" option is changed. The result does not depend on $PATH because no
+ * external command is searched for. */
+void search_builtin_or_function_cached(command_T *restrict c,
+        const char *restrict name, const wchar_t *restrict wname,
+        commandinfo_T *restrict ci)
+{
+    struct cmdcache_T *cache = c->c_cmdcache;
+    if (cache != NULL
+            && cache->funcgen == function_generation
+            && cache->posix == posixly_correct
+            && wcscmp(cache->name, wname) == 0) {
+        *ci = cache->info;
+        return;
+    }
+
+    search_command(name, wname, ci, SCT_BUILTIN | SCT_FUNCTION);
+
+    size_t namelen = wcslen(wname);
+    free(cache);
+    cache = xmallocs(sizeof *cache, namelen + 1, sizeof *cache->name);
+    cache->funcgen = function_generation;
+    cache->posix = posixly_correct;
+    cache->info = *ci;
+    wmemcpy(cache->name, wname, namelen + 1);
+    c->c_cmdcache = cache;
+}
+
 /* Returns true iff the specified command is a special built-in. */
 bool is_special_builtin(const char *cmdname)
 {
@@ -1319,7 +1494,7 @@ void exec_for(const command_T *c, bool finally_exit)
 
     int i;
     for (i = 0; i < count; i++) {
-        if (!set_variable(c->c_forname, words[i],
+        if (!set_variable_with_hash(c->c_forname, c->c_fornamehash, words[i],
                     shopt_forlocal && !posixly_correct ?
                         SCOPE_LOCAL : SCOPE_GLOBAL,
                     false)) {
@@ -1493,6 +1668,9 @@ fork_and_wait_T fork_and_wait(sigtype_T sigtype)
  *   t_leave: Don't clear traps and shell FDs. Restore the signal mask for
  *          SIGCHLD. Don't reset `execstate'. This option must be used iff the
  *          shell is going to `exec' to an external program.
+ *   t_keepcoproc: Don't close the FDs connected to coprocesses. This option is
+ *          used for command substitutions and process redirections, which may
+ *          communicate with coprocesses on behalf of the shell.
  * Returns the return value of `fork'. */
 pid_t fork_and_reset(pid_t pgid, bool fg, sigtype_T sigtype)
 {
@@ -1557,6 +1735,8 @@ void become_child(sigtype_T sigtype)
 
     restore_signals(sigtype & t_leave);  /* signal mask is restored here */
     clear_shellfds(sigtype & t_leave);
+    if (!(sigtype & t_keepcoproc))
+        clear_coprocfds(sigtype & t_leave);
     is_interactive_now = false;
     suppresserrreturn = false;
     exitstatus = -1;
@@ -1585,7 +1765,7 @@ wchar_t *exec_command_substitution(const embedcmd_T *cmdsub)
     /* If the child is stopped by SIGTSTP, it can never be resumed and
      * the shell will be stuck. So we specify the `t_tstp' flag to prevent the
      * child from being stopped by SIGTSTP. */
-    cpid = fork_and_reset(-1, false, t_tstp);
+    cpid = fork_and_reset(-1, false, t_tstp | t_keepcoproc);
     if (cpid < 0) {
         /* fork failure */
         xclose(pipefd[PIPE_IN]);
@@ -1743,7 +1923,7 @@ bool autoload_completion_function_file(
     if (mbsfilename == NULL)
         return false;
 
-    char *path = which(mbsfilename, get_path_array(PA_LOADPATH),
+    char *path = which_indexed(mbsfilename, get_path_array(PA_LOADPATH),
             is_readable_regular);
     if (path == NULL) {
         le_compdebug("file \"%s\" was not found in $YASH_LOADPATH",
@@ -1833,6 +2013,17 @@ static void print_command_absolute_path(
 static void print_command_path(
         const char *name, const char *path, bool humanfriendly)
     __attribute__((nonnull));
+static bool open_coproc_pipe(int pipefd[2])
+    __attribute__((nonnull));
+static void exec_eval(const wchar_t *code)
+    __attribute__((nonnull));
+static struct evalcache_T *get_eval_cache(const wchar_t *code)
+    __attribute__((nonnull));
+static struct evalcache_T *add_eval_cache(
+        const wchar_t *code, and_or_T *commands)
+    __attribute__((nonnull(1)));
+static void free_eval_cache(struct evalcache_T *ec);
+static void kvfree_eval_cache(kvpair_T kv);
 
 /* Options for the "break", "continue" and "eval" built-ins. */
 const struct xgetopt_T iter_options[] = {
@@ -1843,6 +2034,20 @@ const struct xgetopt_T iter_options[] = {
     { L'\0', NULL, 0, false, NULL, },
 };
 
+#ifndef NDEBUG
+/* Options for the "eval" built-in in the debug build.
+ * The built-in is registered with `iter_options' so that the debug-only option
+ * does not appear in the help. */
+static const struct xgetopt_T eval_options[] = {
+    { L'i', L"iteration",   OPTARG_NONE, false, NULL, },
+    { L'S', L"cache-stats", OPTARG_NONE, false, NULL, },
+#if YASH_ENABLE_HELP
+    { L'-', L"help",        OPTARG_NONE, false, NULL, },
+#endif
+    { L'\0', NULL, 0, false, NULL, },
+};
+#endif
+
 /* Options for the "return" built-in. */
 const struct xgetopt_T return_options[] = {
     { L'n', L"no-return", OPTARG_NONE, false, NULL, },
@@ -2003,19 +2208,202 @@ const char continue_syntax[] = Ngt(
 
 #endif
 
+/* A parse tree cached for the "eval" built-in. */
+typedef struct evalcache_T {
+    refcount_T refcount;
+    and_or_T *commands;  /* null if the code cannot be cached */
+    bool posix;          /* value of `posixly_correct' when parsed */
+} evalcache_T;
+/* The parse tree is shared by the cache and the executions of the tree that
+ * are in progress, so it is freed when the last of them releases it. If the
+ * code consists of more than one line, `commands' is null, which means the
+ * code has to be parsed line by line each time it is executed because an alias
+ * defined in one line affects parsing of the following lines. */
+
+/* The maximum number of entries in `evalcache'. */
+#define EVAL_CACHE_MAX_ENTRIES 64
+/* The maximum length of code that is cached. */
+#define EVAL_CACHE_MAX_LENGTH 4096
+
+/* Hashtable mapping code strings (wide strings) to `evalcache_T's. */
+static hashtable_T evalcache = { .capacity = 0 };
+/* The value of `alias_generation' when the cached trees were parsed. */
+static unsigned long evalcache_aliasgen;
+/* The number of executions of the "eval" built-in that reused a cached parse
+ * tree and that parsed the code. */
+static unsigned long evalcache_hits, evalcache_misses;
+
+/* Parses and executes the specified code for the "eval" built-in.
+ * The result is the same as that of `exec_wcs(code, "eval", false)', but the
+ * parse tree is cached so that it can be reused when the same code is
+ * evaluated again. */
+void exec_eval(const wchar_t *code)
+{
+    evalcache_T *ec = get_eval_cache(code);
+    if (ec != NULL && ec->commands == NULL) {
+        /* cached as uncacheable */
+        evalcache_misses++;
+        exec_wcs(code, "eval", false);
+        return;
+    }
+
+    and_or_T *commands;
+    if (ec != NULL) {
+        evalcache_hits++;
+        refcount_increment(&ec->refcount);
+        commands = ec->commands;
+    } else {
+        evalcache_misses++;
+        if (need_break())
+            return;
+
+        struct input_wcs_info_T iinfo = {
+            .src = code,
+        };
+        struct parseparam_T pinfo = {
+            .print_errmsg = true,
+            .enable_verbose = false,
+            .enable_alias = true,
+            .filename = "eval",
+            .lineno = 1,
+            .input = input_wcs,
+            .inputinfo = &iinfo,
+            .interactive = false,
+        };
+
+        switch (read_and_parse(&pinfo, &commands)) {
+            case PR_OK:
+                break;
+            case PR_EOF:
+                laststatus = Exit_SUCCESS;
+                return;
+            case PR_SYNTAX_ERROR:
+                if (shell_initialized && !is_interactive_now)
+                    exit_shell_with_status(Exit_SYNERROR);
+                laststatus = Exit_SYNERROR;
+                return;
+            case PR_INPUT_ERROR:
+                laststatus = Exit_ERROR;
+                return;
+        }
+
+        if (iinfo.src != NULL) {
+            /* The code has more lines that have to be parsed after executing
+             * the first line. Start over in the ordinary way. */
+            andorsfree(commands);
+            (void) add_eval_cache(code, NULL);
+            exec_wcs(code, "eval", false);
+            return;
+        }
+        if (commands == NULL) {
+            laststatus = Exit_SUCCESS;
+            return;
+        }
+
+        ec = add_eval_cache(code, commands);
+        if (ec != NULL)
+            refcount_increment(&ec->refcount);
+    }
+
+    if (shopt_exec || is_interactive)
+        exec_and_or_lists(commands, false);
+    else
+        laststatus = Exit_SUCCESS;
+
+    if (ec != NULL)
+        free_eval_cache(ec);
+    else
+        andorsfree(commands);
+}
+
+/* Returns the cache entry for the specified code, or NULL if not cached.
+ * All the entries are discarded if aliases have been modified since they were
+ * cached. */
+evalcache_T *get_eval_cache(const wchar_t *code)
+{
+    if (evalcache.capacity == 0)
+        return NULL;
+    if (evalcache_aliasgen != alias_generation) {
+        ht_clear(&evalcache, kvfree_eval_cache);
+        return NULL;
+    }
+
+    evalcache_T *ec = ht_getwcs(&evalcache, code).value;
+    if (ec != NULL && ec->posix != posixly_correct)
+        return NULL;
+    return ec;
+}
+
+/* Caches the specified parse tree for the specified code.
+ * `commands' may be NULL to indicate that the code cannot be cached.
+ * Returns the new cache entry, which owns `commands'. If the code is too long
+ * to be cached, NULL is returned and `commands' is not owned by the cache. */
+evalcache_T *add_eval_cache(const wchar_t *code, and_or_T *commands)
+{
+    if (wcslen(code) > EVAL_CACHE_MAX_LENGTH)
+        return NULL;
+
+    if (evalcache.capacity == 0)
+        ht_init(&evalcache, hashwcs, htwcscmp);
+    if (evalcache_aliasgen != alias_generation ||
+            evalcache.count >= EVAL_CACHE_MAX_ENTRIES)
+        ht_clear(&evalcache, kvfree_eval_cache);
+    evalcache_aliasgen = alias_generation;
+
+    evalcache_T *ec = xmalloc(sizeof *ec);
+    ec->refcount = 1;
+    ec->commands = commands;
+    ec->posix = posixly_correct;
+    kvfree_eval_cache(ht_set(&evalcache, xwcsdup(code), ec));
+    return ec;
+}
+
+/* Decreases the reference count of the specified cache entry and, if the count
+ * becomes zero, frees it. This function does nothing if `ec' is NULL. */
+void free_eval_cache(evalcache_T *ec)
+{
+    if (ec != NULL) {
+        if (refcount_decrement(&ec->refcount)) {
+            andorsfree(ec->commands);
+            free(ec);
+        }
+    }
+}
+
+/* Frees the key and the value of the specified key-value pair of `evalcache'.
+ */
+void kvfree_eval_cache(kvpair_T kv)
+{
+    free(kv.key);
+    free_eval_cache(kv.value);
+}
+
 /* The "eval" built-in, which accepts the following option:
- *  -i: iterative execution */
+ *  -i: iterative execution
+ * In the debug build, the following option is also accepted:
+ *  -S: print statistics of the parse tree cache */
 int eval_builtin(int argc __attribute__((unused)), void **argv)
 {
     bool iter = false;
+#ifndef NDEBUG
+    bool stats = false;
+    const struct xgetopt_T *const options = eval_options;
+#else
+    const struct xgetopt_T *const options = iter_options;
+#endif
 
     const struct xgetopt_T *opt;
     xoptind = 0;
-    while ((opt = xgetopt(argv, iter_options, XGETOPT_POSIX)) != NULL) {
+    while ((opt = xgetopt(argv, options, XGETOPT_POSIX)) != NULL) {
         switch (opt->shortopt) {
             case L'i':
                 iter = true;
                 break;
+#ifndef NDEBUG
+            case L'S':
+                stats = true;
+                break;
+#endif
 #if YASH_ENABLE_HELP
             case L'-':
                 return print_builtin_help(ARGV(0));
@@ -2025,11 +2413,19 @@ int eval_builtin(int argc __attribute__((unused)), void **argv)
         }
     }
 
+#ifndef NDEBUG
+    if (stats) {
+        xprintf("hits: %lu\nmisses: %lu\nentries: %zu\n",
+                evalcache_hits, evalcache_misses, evalcache.count);
+        return yash_error_message_count == 0 ? Exit_SUCCESS : Exit_FAILURE;
+    }
+#endif
+
     if (iter) {
         return exec_iteration(&argv[xoptind], "eval");
     } else {
         wchar_t *args = joinwcsarray(&argv[xoptind], L" ");
-        exec_wcs(args, "eval", false);
+        exec_eval(args);
         free(args);
         return laststatus;
     }
@@ -2096,7 +2492,7 @@ int dot_builtin(int argc, void **argv)
 
     char *path;
     if (autoload) {
-        path = which(mbsfilename, get_path_array(PA_LOADPATH),
+        path = which_indexed(mbsfilename, get_path_array(PA_LOADPATH),
                 is_readable_regular);
         if (path == NULL) {
             xerror(0, Ngt("file `%s' was not found in $YASH_LOADPATH"),
@@ -2312,6 +2708,175 @@ const char exec_syntax[] = Ngt(
 );
 #endif
 
+/* The minimum file descriptor number of the pipes to coprocesses.
+ * File descriptors 0-9 are left for the user's redirections. */
+#define COPROC_FDMIN 10
+
+/* Options for the "coproc" built-in. */
+const struct xgetopt_T coproc_options[] = {
+    { L'v', L"variable", OPTARG_REQUIRED, false, NULL, },
+#if YASH_ENABLE_HELP
+    { L'-', L"help",     OPTARG_NONE,     false, NULL, },
+#endif
+    { L'\0', NULL, 0, false, NULL, },
+};
+
+/* The "coproc" built-in, which accepts the following option:
+ *  -v name: name of the array to assign the file descriptors to
+ * The built-in starts the command specified by the operands as an asynchronous
+ * job whose standard input and output are connected to the shell by pipes. */
+int coproc_builtin(int argc, void **argv)
+{
+    const wchar_t *varname = L VAR_COPROC;
+
+    const struct xgetopt_T *opt;
+    xoptind = 0;
+    while ((opt = xgetopt(argv, coproc_options, XGETOPT_POSIX)) != NULL) {
+        switch (opt->shortopt) {
+            case L'v':  varname = xoptarg;  break;
+#if YASH_ENABLE_HELP
+            case L'-':
+                return print_builtin_help(ARGV(0));
+#endif
+            default:
+                return Exit_ERROR;
+        }
+    }
+
+    if (xoptind == argc)
+        return insufficient_operands_error(1);
+    if (!is_name(varname)) {
+        xerror(0, Ngt("`%ls' is not a valid variable name"), varname);
+        return Exit_ERROR;
+    }
+
+    int cargc = argc - xoptind;
+    void **cargv = &argv[xoptind];
+    char *argv0 = malloc_wcstombs(cargv[0]);
+    if (argv0 == NULL) {
+        xerror(EILSEQ, NULL);
+        return Exit_NOTFOUND;
+    }
+
+    /* `inpipe' and `outpipe' are connected to the standard input and output
+     * of the coprocess, respectively. */
+    int inpipe[2], outpipe[2];
+    if (!open_coproc_pipe(inpipe)) {
+        free(argv0);
+        return Exit_FAILURE;
+    }
+    if (!open_coproc_pipe(outpipe)) {
+        xclose(inpipe[PIPE_IN]);
+        xclose(inpipe[PIPE_OUT]);
+        free(argv0);
+        return Exit_FAILURE;
+    }
+
+    pid_t cpid = fork_and_reset(0, false, t_quitint);
+    if (cpid == 0) {
+        /* child process: execute the command and then exit */
+        xclose(inpipe[PIPE_OUT]);
+        xclose(outpipe[PIPE_IN]);
+        if (xdup2(inpipe[PIPE_IN], STDIN_FILENO) < 0
+                || xdup2(outpipe[PIPE_OUT], STDOUT_FILENO) < 0)
+            exit(Exit_NOEXEC);
+        xclose(inpipe[PIPE_IN]);
+        xclose(outpipe[PIPE_OUT]);
+
+        commandinfo_T ci;
+        search_command(argv0, cargv[0], &ci,
+                SCT_EXTERNAL | SCT_BUILTIN | SCT_FUNCTION);
+        wchar_t **namep =
+            invoke_simple_command(&ci, cargc, argv0, cargv, true);
+        (void) namep;
+        assert(false);
+    }
+
+    free(argv0);
+    xclose(inpipe[PIPE_IN]);
+    xclose(outpipe[PIPE_OUT]);
+    if (cpid < 0) {
+        /* fork failure */
+        xclose(inpipe[PIPE_OUT]);
+        xclose(outpipe[PIPE_IN]);
+        return Exit_NOEXEC;
+    }
+
+    /* parent process: add a new job */
+    job_T *job = xmalloc(add(sizeof *job, sizeof *job->j_procs));
+    process_T *ps = job->j_procs;
+
+    ps->pr_pid = cpid;
+    ps->pr_status = JS_RUNNING;
+    ps->pr_statuscode = 0;
+    ps->pr_name = joinwcsarray(cargv, L" ");
+
+    job->j_pgid = doing_job_control_now ? cpid : 0;
+    job->j_status = JS_RUNNING;
+    job->j_statuschanged = true;
+    job->j_legacy = false;
+    job->j_nonotify = false;
+    job->j_pcount = 1;
+
+    set_active_job(job);
+    add_job(shopt_curasync);
+    lastasyncpid = cpid;
+
+    /* The first element is the FD to read the output of the coprocess from
+     * and the second is the FD to write the input to the coprocess to. */
+    void **fds = xmallocn(3, sizeof *fds);
+    fds[0] = malloc_wprintf(L"%d", outpipe[PIPE_IN]);
+    fds[1] = malloc_wprintf(L"%d", inpipe[PIPE_OUT]);
+    fds[2] = NULL;
+    if (set_array(varname, 2, fds, SCOPE_GLOBAL, false) == NULL) {
+        xclose(inpipe[PIPE_OUT]);
+        xclose(outpipe[PIPE_IN]);
+        return Exit_FAILURE;
+    }
+    add_coprocfd(outpipe[PIPE_IN]);
+    add_coprocfd(inpipe[PIPE_OUT]);
+    return Exit_SUCCESS;
+}
+
+/* Opens a pipe for the "coproc" built-in.
+ * Both ends of the pipe are moved to close-on-exec FDs not less than
+ * `COPROC_FDMIN' so that they do not interfere with the standard input and
+ * output of the coprocess and are not inherited by other commands.
+ * The shell's ends are added to the coprocess FDs by the caller so that
+ * subshells do not inherit them either.
+ * Returns true iff successful. */
+bool open_coproc_pipe(int pipefd[2])
+{
+    if (pipe(pipefd) < 0)
+        goto error;
+    for (int i = 0; i < 2; i++) {
+        int newfd = copy_as_cloexec_fd(pipefd[i], COPROC_FDMIN);
+        if (newfd < 0) {
+            int saveerrno = errno;
+            xclose(pipefd[PIPE_IN]);
+            xclose(pipefd[PIPE_OUT]);
+            errno = saveerrno;
+            goto error;
+        }
+        xclose(pipefd[i]);
+        pipefd[i] = newfd;
+    }
+    return true;
+
+error:
+    xerror(errno, Ngt("cannot open a pipe for the coprocess"));
+    return false;
+}
+
+#if YASH_ENABLE_HELP
+const char coproc_help[] = Ngt(
+"start a coprocess"
+);
+const char coproc_syntax[] = Ngt(
+"\tcoproc [-v name] command [argument...]\n"
+);
+#endif
+
 /* Options for the "command" built-in. */
 const struct xgetopt_T command_options[] = {
     { L'a', L"alias",            OPTARG_NONE, false, NULL, },
@@ -29,6 +29,7 @@ typedef enum sigtype_T {
     t_quitint    = 1 << 0,
     t_tstp       = 1 << 1,
     t_leave      = 1 << 2,
+    t_keepcoproc = 1 << 3,
 } sigtype_T;
 
 #define Exit_SUCCESS  0
@@ -117,6 +118,13 @@ extern const char exec_help[], exec_syntax[];
 #endif
 extern const struct xgetopt_T exec_options[];
 
+extern int coproc_builtin(int argc, void **argv)
+    __attribute__((nonnull));
+#if YASH_ENABLE_HELP
+extern const char coproc_help[], coproc_syntax[];
+#endif
+extern const struct xgetopt_T coproc_options[];
+
 extern int command_builtin(int argc, void **argv)
     __attribute__((nonnull));
 #if YASH_ENABLE_HELP
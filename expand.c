@@ -53,6 +53,12 @@ struct expand_four_T {
  * must have as many strings as `valuelist' and each string in `cclist' must
  * have the same length as the corresponding wide string in `valuelist'. */
 
+static const wchar_t *literal_word(const wordunit_T *w,
+        tildetype_T tilde, const wchar_t *restrict specials)
+    __attribute__((nonnull(3),pure));
+static bool expand_quoted_param(
+        const wordunit_T *restrict w, plist_T *restrict list)
+    __attribute__((nonnull(2)));
 static plist_T expand_word(const wordunit_T *w)
     __attribute__((warn_unused_result));
 static struct expand_four_T expand_four(const wordunit_T *restrict w,
@@ -128,11 +134,15 @@ static bool has_leading_zero(const wchar_t *restrict s, bool *restrict sign)
 static void fieldsplit(void **restrict valuelist, void **restrict cclist,
         plist_T *restrict outvaluelist, plist_T *restrict outcclist)
     __attribute__((nonnull));
-static bool is_ifs_char(wchar_t c, charcategory_T cc, const wchar_t *ifs)
+static inline int ifs_class(wchar_t c, charcategory_T cc, const ifs_T *ifs)
     __attribute__((nonnull,pure));
-static bool is_ifs_whitespace(wchar_t c, charcategory_T cc, const wchar_t *ifs)
+static inline bool is_ifs_char(wchar_t c, charcategory_T cc, const ifs_T *ifs)
     __attribute__((nonnull,pure));
-static bool is_non_ifs_char(wchar_t c, charcategory_T cc, const wchar_t *ifs)
+static inline bool is_ifs_whitespace(
+        wchar_t c, charcategory_T cc, const ifs_T *ifs)
+    __attribute__((nonnull,pure));
+static inline bool is_non_ifs_char(
+        wchar_t c, charcategory_T cc, const ifs_T *ifs)
     __attribute__((nonnull,pure));
 static void add_empty_field(plist_T *dest, const wchar_t *p)
     __attribute__((nonnull));
@@ -192,6 +202,15 @@ bool expand_line(void *const *restrict args,
  * On error in a non-interactive shell, the shell exits. */
 bool expand_multiple(const wordunit_T *w, plist_T *list)
 {
+    /* fast path for a word that expands to itself */
+    const wchar_t *literal = literal_field(w);
+    if (literal != NULL) {
+        pl_add(list, xwcsdup(literal));
+        return true;
+    }
+    if (expand_quoted_param(w, list))
+        return true;
+
     /* four expansions (w -> valuelist) */
     struct expand_four_T expand = expand_four(w, TT_SINGLE, Q_WORD, CC_LITERAL);
     if (expand.valuelist.contents == NULL) {
@@ -274,6 +293,104 @@ struct cc_word_T expand_single_cc(
     return (struct cc_word_T) { wb_towcs(&valuebuf), sb_tostr(&ccbuf) };
 }
 
+/* Checks if the specified word expands to itself as a single field in
+ * `expand_multiple', taking the "braceexpand" and "glob" options into account.
+ * Returns the string if so, or NULL otherwise. */
+const wchar_t *literal_field(const wordunit_T *w)
+{
+    return literal_word(w, TT_SINGLE,
+            shopt_braceexpand ? (shopt_glob ? L"{*?[" : L"{")
+                              : (shopt_glob ? L"*?[" : L""));
+}
+
+/* Checks if the specified word expands to itself.
+ * A word expands to itself if it consists of a single non-empty string that
+ * contains no quotations, backslashes, or characters in `specials' and that is
+ * not subject to tilde expansion. The results of expansion of such a word
+ * consist of literal characters only, so we can skip building the
+ * charcategory_T strings, field splitting, and quote removal for it.
+ * Returns the string if the word expands to itself, or NULL otherwise. */
+const wchar_t *literal_word(
+        const wordunit_T *w, tildetype_T tilde, const wchar_t *specials)
+{
+    if (w == NULL || w->next != NULL || w->wu_type != WT_STRING)
+        return NULL;
+
+    const wchar_t *s = w->wu_string;
+    if (s[0] == L'\0')
+        return NULL;
+    if (tilde != TT_NONE && s[0] == L'~')
+        return NULL;
+    for (const wchar_t *p = s; *p != L'\0'; p++) {
+        switch (*p) {
+            case L'"':  case L'\'':  case L'\\':
+                return NULL;
+            case L':':
+                if (tilde == TT_MULTI)
+                    return NULL;
+                break;
+            default:
+                if (wcschr(specials, *p) != NULL)
+                    return NULL;
+                break;
+        }
+    }
+    return s;
+}
+
+/* Expands a word of the form "$name", "${name}", or "${name[@]}" (including
+ * the double quotes) to the values of the parameter.
+ * The values of such a word are added to `list' as is because they are neither
+ * split nor globbed and have no quotations to remove, so we can skip building
+ * the charcategory_T strings for them. If the word has other forms or the
+ * parameter is not set, this function does nothing and returns false so that
+ * the caller expands the word in the ordinary way. */
+bool expand_quoted_param(const wordunit_T *restrict w, plist_T *restrict list)
+{
+    const wordunit_T *w2, *w3;
+    if (w == NULL || w->wu_type != WT_STRING
+            || wcscmp(w->wu_string, L"\"") != 0)
+        return false;
+    if ((w2 = w->next) == NULL || w2->wu_type != WT_PARAM)
+        return false;
+    if ((w3 = w2->next) == NULL || w3->wu_type != WT_STRING
+            || wcscmp(w3->wu_string, L"\"") != 0 || w3->next != NULL)
+        return false;
+
+    const paramexp_T *p = w2->wu_param;
+    if (p->pe_type != PT_NONE || p->pe_end != NULL)
+        return false;
+    if (p->pe_start != NULL) {
+        const wordunit_T *index = p->pe_start;
+        if (index->next != NULL || index->wu_type != WT_STRING ||
+                wcscmp(index->wu_string, L"@") != 0)
+            return false;
+    }
+
+    struct get_variable_T v =
+        get_variable_with_hash(p->pe_name, p->pe_namehash);
+    switch (v.type) {
+        case GV_NOTFOUND:
+            return false;
+        case GV_ARRAY_CONCAT:
+            if (v.freevalues)
+                plfree(v.values, free);
+            return false;
+        case GV_SCALAR:
+        case GV_ARRAY:
+            break;
+    }
+
+    if (v.freevalues) {
+        pl_ncat(list, v.values, v.count);
+        free(v.values);
+    } else {
+        for (size_t i = 0; i < v.count; i++)
+            pl_add(list, xwcsdup(v.values[i]));
+    }
+    return true;
+}
+
 /* Expands a word to (possibly any number of) fields.
  * If successful, the return value is a plist_T containing newly malloced wide
  * strings. In most cases, the plist_T contains one string. If the word contains
@@ -302,6 +419,10 @@ plist_T expand_word(const wordunit_T *w)
 wchar_t *expand_single(const wordunit_T *w,
         tildetype_T tilde, quoting_T quoting, escaping_T escaping)
 {
+    const wchar_t *literal = literal_word(w, tilde, L"");
+    if (literal != NULL)
+        return xwcsdup(literal);
+
     cc_word_T e = expand_single_cc(w, tilde, quoting);
     if (e.value == NULL)
         return NULL;
@@ -705,7 +826,7 @@ struct expand_four_T expand_param(const paramexp_T *p, bool indq)
         v.freevalues = true;
         unset = false;
     } else {
-        v = get_variable(p->pe_name);
+        v = get_variable_with_hash(p->pe_name, p->pe_namehash);
         if (v.type == GV_NOTFOUND) {
             /* if the variable is not set, return empty string */
             v.type = GV_SCALAR;
@@ -1529,9 +1650,12 @@ bool has_leading_zero(const wchar_t *restrict s, bool *restrict sign)
 void fieldsplit(void **restrict const valuelist, void **restrict const cclist,
         plist_T *restrict outvaluelist, plist_T *restrict outcclist)
 {
-    const wchar_t *ifs = getvar(L VAR_IFS);
-    if (ifs == NULL)
-        ifs = DEFAULT_IFS;
+    const wchar_t *ifschars = getvar(L VAR_IFS);
+    if (ifschars == NULL)
+        ifschars = DEFAULT_IFS;
+
+    ifs_T ifs;
+    init_ifs(&ifs, ifschars);
 
     plist_T fields;
     pl_init(&fields);
@@ -1539,7 +1663,7 @@ void fieldsplit(void **restrict const valuelist, void **restrict const cclist,
     for (size_t i = 0; valuelist[i] != NULL; i++) {
         wchar_t *s = valuelist[i];
         char *cc = cclist[i];
-        extract_fields(s, cc, ifs, &fields);
+        extract_fields(s, cc, &ifs, &fields);
         assert(fields.length % 2 == 0);
 
         if (fields.length == 2 && fields.contents[0] == s &&
@@ -1567,11 +1691,29 @@ void fieldsplit(void **restrict const valuelist, void **restrict const cclist,
     free(cclist);
 }
 
+/* Initializes `ifs' with the specified value of $IFS.
+ * `chars' is not copied; it must be kept valid while `ifs' is used.
+ * Returns `ifs'. */
+ifs_T *init_ifs(ifs_T *restrict ifs, const wchar_t *restrict chars)
+{
+    ifs->chars = chars;
+    memset(ifs->table, 0, sizeof ifs->table);
+    ifs->has_large_chars = false;
+
+    for (const wchar_t *c = chars; *c != L'\0'; c++) {
+        if ((unsigned long) *c < IFS_TABLE_SIZE)
+            ifs->table[*c] = IFS_CHAR | (iswspace(*c) ? IFS_WHITESPACE : 0);
+        else
+            ifs->has_large_chars = true;
+    }
+    return ifs;
+}
+
 /* Extracts fields from a string.
  * `s' is the word to split.
  * `cc` is an array of charcategory_T values corresponding to `s'. It must be at
  * least as long as `wcslen(s)'.
- * `ifs' must not be NULL.
+ * `ifs' must have been initialized by `init_ifs'.
  *
  * The results are appended to `dest'. If n fields are found, 2n pointers are
  * appended to `dest'. The first pointer points to the first character of the
@@ -1600,7 +1742,7 @@ void fieldsplit(void **restrict const valuelist, void **restrict const cclist,
  *   "abc - - 123"       ->   "abc" "" "123"
  */
 wchar_t *extract_fields(const wchar_t *restrict s, const char *restrict cc,
-        const wchar_t *restrict ifs, plist_T *restrict dest)
+        const ifs_T *restrict ifs, plist_T *restrict dest)
 {
     size_t index = 0;
     size_t ifswhitestartindex;
@@ -1651,22 +1793,36 @@ wchar_t *extract_fields(const wchar_t *restrict s, const char *restrict cc,
     return (wchar_t *) &s[ifswhitestartindex];
 }
 
+/* Returns bitwise or of IFS_CHAR and IFS_WHITESPACE that applies to `c'.
+ * Zero is returned for the null character and characters that are not subject
+ * to field splitting. */
+int ifs_class(wchar_t c, charcategory_T cc, const ifs_T *ifs)
+{
+    if (cc != CC_SOFT_EXPANSION)
+        return 0;
+    if ((unsigned long) c < IFS_TABLE_SIZE)
+        return ifs->table[c];
+    if (!ifs->has_large_chars || wcschr(ifs->chars, c) == NULL)
+        return 0;
+    return IFS_CHAR | (iswspace(c) ? IFS_WHITESPACE : 0);
+}
+
 /* Returns true if `c' is a non-null, IFS character. */
-bool is_ifs_char(wchar_t c, charcategory_T cc, const wchar_t *ifs)
+bool is_ifs_char(wchar_t c, charcategory_T cc, const ifs_T *ifs)
 {
-    return cc == CC_SOFT_EXPANSION && c != L'\0' && wcschr(ifs, c) != NULL;
+    return ifs_class(c, cc, ifs) != 0;
 }
 
 /* Returns true if `c' is a non-null, IFS-whitespace character. */
-bool is_ifs_whitespace(wchar_t c, charcategory_T cc, const wchar_t *ifs)
+bool is_ifs_whitespace(wchar_t c, charcategory_T cc, const ifs_T *ifs)
 {
-    return is_ifs_char(c, cc, ifs) && iswspace(c);
+    return ifs_class(c, cc, ifs) & IFS_WHITESPACE;
 }
 
 /* Returns true if `c' is a non-null, non-IFS character. */
-bool is_non_ifs_char(wchar_t c, charcategory_T cc, const wchar_t *ifs)
+bool is_non_ifs_char(wchar_t c, charcategory_T cc, const ifs_T *ifs)
 {
-    return c != L'\0' && !is_ifs_char(c, cc, ifs);
+    return c != L'\0' && ifs_class(c, cc, ifs) == 0;
 }
 
 void add_empty_field(plist_T *dest, const wchar_t *p)
@@ -76,6 +76,19 @@ typedef enum {
  * characters. This does not apply to ES_QUOTED because the pattern is
  * supposed to be matched without quote removal. */
 
+/* Classification of the characters in $IFS, precomputed for field splitting.
+ * For characters whose values are less than IFS_TABLE_SIZE, `table' contains
+ * bitwise or of the IFS_CHAR and IFS_WHITESPACE flags. Other characters are
+ * looked up in `chars' only if `has_large_chars' is true. */
+#define IFS_TABLE_SIZE 128
+typedef struct ifs_T {
+    const wchar_t *chars;  /* the value of $IFS */
+    unsigned char table[IFS_TABLE_SIZE];
+    _Bool has_large_chars;
+} ifs_T;
+#define IFS_CHAR       (1 << 0)
+#define IFS_WHITESPACE (1 << 1)
+
 /* result of word expansion */
 typedef struct cc_word_T {
     wchar_t *value;  /* word value */
@@ -92,6 +105,8 @@ extern _Bool expand_line(
 extern _Bool expand_multiple(
         const struct wordunit_T *restrict w, struct plist_T *restrict list)
     __attribute__((nonnull(2)));
+extern const wchar_t *literal_field(const struct wordunit_T *w)
+    __attribute__((pure));
 extern struct cc_word_T expand_single_cc(
         const struct wordunit_T *w, tildetype_T tilde, quoting_T quoting)
     __attribute__((warn_unused_result));
@@ -102,9 +117,11 @@ extern wchar_t *expand_single(
 extern char *expand_single_with_glob(const struct wordunit_T *arg)
     __attribute__((malloc,warn_unused_result));
 
+extern ifs_T *init_ifs(ifs_T *restrict ifs, const wchar_t *restrict chars)
+    __attribute__((nonnull));
 extern wchar_t *extract_fields(
         const wchar_t *restrict s, const char *restrict cc,
-        const wchar_t *restrict ifs, struct plist_T *restrict dest)
+        const ifs_T *restrict ifs, struct plist_T *restrict dest)
     __attribute__((nonnull));
 
 struct xwcsbuf_T;
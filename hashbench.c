@@ -0,0 +1,190 @@
+// This is a benchmark tool, not part of yash
+//   make hashtable.o util.o
+//   mkdir -p hashbench-old
+//   git show a18514e^:hashtable.c >hashbench-old/hashtable.c
+//   git show a18514e^:hashtable.h >hashbench-old/hashtable.h
+//   c99 -O2 -I. -DHASHBENCH_OLD -c -o hashbench-old.o hashbench.c
+//   c99 -O2 -o hashbench hashbench.c hashbench-old.o hashtable.o util.o
+//   ./hashbench [count] [rounds]
+// It compares the lookup speed of the former hashtable implementation (prime
+// capacities, FNV hash called through function pointers) with the current one.
+// Half of the looked-up keys are missing from the tables. Each measurement is
+// repeated and the fastest run is reported to reduce noise.
+#ifdef HASHBENCH_OLD
+
+/* The former implementation is compiled with its external names prefixed. */
+#define ht_initwithcapacity old_ht_initwithcapacity
+#define ht_init             old_ht_init
+#define ht_destroy          old_ht_destroy
+#define ht_setcapacity      old_ht_setcapacity
+#define ht_ensurecapacity   old_ht_ensurecapacity
+#define ht_clear            old_ht_clear
+#define ht_get              old_ht_get
+#define ht_set              old_ht_set
+#define ht_remove           old_ht_remove
+#define ht_each             old_ht_each
+#define ht_next             old_ht_next
+#define ht_tokvarray        old_ht_tokvarray
+#define hashstr             old_hashstr
+#define hashwcs             old_hashwcs
+#define htwcscmp            old_htwcscmp
+#define keystrcoll          old_keystrcoll
+#define keywcscoll          old_keywcscoll
+#define kfree               old_kfree
+#define vfree               old_vfree
+#define kvfree              old_kvfree
+#include "hashbench-old/hashtable.c"
+
+#else /* !defined(HASHBENCH_OLD) */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+#include "hashtable.h"
+
+/* The hashtable structure is the same in both implementations. */
+extern hashtable_T *old_ht_initwithcapacity(hashtable_T *ht,
+        hashfunc_T *hashfunc, keycmp_T *keycmp, size_t capacity);
+extern kvpair_T old_ht_get(const hashtable_T *ht, const void *key);
+extern kvpair_T old_ht_set(hashtable_T *ht, const void *key, const void *value);
+extern hashval_T old_hashstr(const void *s);
+extern hashval_T old_hashwcs(const void *s);
+extern int old_htwcscmp(const void *s1, const void *s2);
+
+#define TRIALS 25
+
+enum method { OLD_GET, NEW_GET, NEW_GETSTRING, METHODS, };
+static const char *const method_names[METHODS] = {
+    "former ht_get", "current ht_get", "current ht_getstr/ht_getwcs",
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t sink;
+
+static double run_wide(enum method m, const hashtable_T *ht,
+        wchar_t **keys, size_t count, size_t rounds)
+{
+    double start = now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            switch (m) {
+                case OLD_GET:
+                    sink += (size_t) old_ht_get(ht, keys[i]).value;
+                    break;
+                case NEW_GET:
+                    sink += (size_t) ht_get(ht, keys[i]).value;
+                    break;
+                default:
+                    sink += (size_t) ht_getwcs(ht, keys[i]).value;
+                    break;
+            }
+        }
+    }
+    return now() - start;
+}
+
+static double run_byte(enum method m, const hashtable_T *ht,
+        char **keys, size_t count, size_t rounds)
+{
+    double start = now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            switch (m) {
+                case OLD_GET:
+                    sink += (size_t) old_ht_get(ht, keys[i]).value;
+                    break;
+                case NEW_GET:
+                    sink += (size_t) ht_get(ht, keys[i]).value;
+                    break;
+                default:
+                    sink += (size_t) ht_getstr(ht, keys[i]).value;
+                    break;
+            }
+        }
+    }
+    return now() - start;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200;
+    size_t rounds = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000;
+    if (count == 0)
+        count = 1;
+
+    /* names resembling shell variable and command names; only the first half
+     * of them are added to the tables */
+    size_t total = count * 2;
+    wchar_t **wkeys = malloc(total * sizeof *wkeys);
+    char **keys = malloc(total * sizeof *keys);
+    for (size_t i = 0; i < total; i++) {
+        wchar_t wbuf[32];
+        char buf[32];
+        swprintf(wbuf, sizeof wbuf / sizeof *wbuf, L"NAME_%zu", i);
+        snprintf(buf, sizeof buf, "cmd-%zu", i);
+        wkeys[i] = wcsdup(wbuf);
+        keys[i] = strdup(buf);
+    }
+
+    /* The former default initial capacity was 5. */
+    hashtable_T oldw, neww, olds, news;
+    old_ht_initwithcapacity(&oldw, old_hashwcs, old_htwcscmp, 5);
+    ht_init(&neww, hashwcs, htwcscmp);
+    old_ht_initwithcapacity(&olds, old_hashstr, htstrcmp, 5);
+    ht_init(&news, hashstr, htstrcmp);
+    for (size_t i = 0; i < count; i++) {
+        old_ht_set(&oldw, wkeys[i], wkeys[i]);
+        ht_set(&neww, wkeys[i], wkeys[i]);
+        old_ht_set(&olds, keys[i], keys[i]);
+        ht_set(&news, keys[i], keys[i]);
+    }
+
+    /* look the keys up in a random order */
+    srand(1);
+    for (size_t i = total; i > 1; i--) {
+        size_t j = (size_t) rand() % i;
+        wchar_t *wtmp = wkeys[i - 1];
+        wkeys[i - 1] = wkeys[j];
+        wkeys[j] = wtmp;
+        char *tmp = keys[i - 1];
+        keys[i - 1] = keys[j];
+        keys[j] = tmp;
+    }
+
+    double wbest[METHODS], bbest[METHODS];
+    for (int m = 0; m < METHODS; m++)
+        wbest[m] = bbest[m] = 1e9;
+    for (int t = 0; t < TRIALS; t++) {
+        for (int m = 0; m < METHODS; m++) {
+            const hashtable_T *wt = (m == OLD_GET) ? &oldw : &neww;
+            const hashtable_T *bt = (m == OLD_GET) ? &olds : &news;
+            double w = run_wide(m, wt, wkeys, total, rounds);
+            double b = run_byte(m, bt, keys, total, rounds);
+            if (wbest[m] > w)
+                wbest[m] = w;
+            if (bbest[m] > b)
+                bbest[m] = b;
+        }
+    }
+
+    size_t lookups = total * rounds;
+    printf("%zu keys in tables, %zu lookups per trial\n", count, lookups);
+    for (int m = 0; m < METHODS; m++)
+        printf("wide: %-28s %6.2f ns/lookup\n",
+                method_names[m], wbest[m] * 1e9 / lookups);
+    for (int m = 0; m < METHODS; m++)
+        printf("byte: %-28s %6.2f ns/lookup\n",
+                method_names[m], bbest[m] * 1e9 / lookups);
+    return sink == 0;
+}
+
+#endif /* HASHBENCH_OLD */
@@ -19,6 +19,7 @@
 #include "common.h"
 #include "hashtable.h"
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
@@ -28,7 +29,7 @@
 /* A hashtable is a mapping from keys to values.
  * Keys and values are all of type (void *).
  * NULL is allowed as a value, but not as a key.
- * The capacity of a hashtable is always no less than one. */
+ * The capacity of a hashtable is always a power of two. */
 
 /* The hashtable_T structure is defined as follows:
  *   struct hashtable_T {
@@ -41,7 +42,8 @@
  *      size_t            *indices;
  *      struct hash_entry *entries;
  *   }
- * `capacity' is the size of array `entries'.
+ * `capacity' is the size of arrays `indices' and `entries'. The bucket for a
+ * key is chosen by masking the hash value with (`capacity' - 1).
  * `count' is the number of entries contained in the hashtable.
  * `hashfunc' is a pointer to the hash function.
  * `keycmp' is a pointer to the function that compares keys.
@@ -68,10 +70,23 @@ static void print_statistics(const hashtable_T *ht);
 # define DEBUG_PRINT_STATISTICS(ht) ((void) 0)
 #endif
 
+static size_t round_up_capacity(size_t capacity)
+    __attribute__((const));
+static kvpair_T ht_getstrwithhash(
+        const hashtable_T *ht, const char *key, hashval_T hash)
+    __attribute__((nonnull(1)));
+static inline hashval_T hash_mbs(const char *s)
+    __attribute__((nonnull,pure));
+static inline hashval_T hash_wcs(const wchar_t *s)
+    __attribute__((nonnull,pure));
+
 
 /* The null index */
 #define NOTHING ((size_t) -1)
 
+/* Returns the index of the bucket for the specified hash value. */
+#define BUCKET(ht, hash) ((size_t) (hash) & ((ht)->capacity - 1))
+
 /* hashtable entry */
 struct hash_entry {
     size_t next;
@@ -90,8 +105,7 @@ hashtable_T *ht_initwithcapacity(
         hashtable_T *ht, hashfunc_T *hashfunc, keycmp_T *keycmp,
         size_t capacity)
 {
-    if (capacity == 0)
-        capacity = 1;
+    capacity = round_up_capacity(capacity);
 
     ht->capacity = capacity;
     ht->count = 0;
@@ -113,15 +127,12 @@ hashtable_T *ht_initwithcapacity(
 /* Changes the capacity of the specified hashtable.
  * If the specified new capacity is smaller than the number of the entries in
  * the hashtable, the capacity is not changed.
- * Note that the capacity cannot be zero. If `newcapacity' is zero, it is
- * assumed to be one. */
-/* Capacity should be an odd integer, especially a prime number. */
+ * The capacity is rounded up to a power of two. */
 hashtable_T *ht_setcapacity(hashtable_T *ht, size_t newcapacity)
 {
-    if (newcapacity == 0)
-        newcapacity = 1;
     if (newcapacity < ht->count)
         newcapacity = ht->count;
+    newcapacity = round_up_capacity(newcapacity);
 
     size_t oldcapacity = ht->capacity;
     size_t *oldindices = ht->indices;
@@ -140,7 +151,7 @@ hashtable_T *ht_setcapacity(hashtable_T *ht, size_t newcapacity)
         void *key = oldentries[i].kv.key;
         if (key != NULL) {
             hashval_T hash = oldentries[i].hash;
-            size_t newindex = (size_t) hash % newcapacity;
+            size_t newindex = (size_t) hash & (newcapacity - 1);
             newentries[tail] = (struct hash_entry) {
                 .next = newindices[newindex],
                 .hash = hash,
@@ -168,14 +179,24 @@ hashtable_T *ht_ensurecapacity(hashtable_T *ht, size_t capacity)
     if (capacity <= ht->capacity)
         return ht;
 
-    size_t cap15 = ht->capacity + (ht->capacity >> 1);
-    if (capacity < cap15)
-        capacity = cap15;
-    if (capacity < ht->capacity + 6)
-        capacity = ht->capacity + 6;
+    size_t cap2 = ht->capacity * 2;
+    if (capacity < cap2 && cap2 > ht->capacity)
+        capacity = cap2;
     return ht_setcapacity(ht, capacity);
 }
 
+/* Returns the smallest power of two that is no less than `capacity'. */
+size_t round_up_capacity(size_t capacity)
+{
+    size_t result = 1;
+    while (result < capacity) {
+        if (result > SIZE_MAX / 2)
+            alloc_failed();
+        result *= 2;
+    }
+    return result;
+}
+
 /* Removes all the entries of a hashtable.
  * If `freer' is non-NULL, it is called for each entry removed (in an
  * unspecified order).
@@ -209,7 +230,7 @@ kvpair_T ht_get(const hashtable_T *ht, const void *key)
 {
     if (key != NULL) {
         hashval_T hash = ht->hashfunc(key);
-        size_t index = ht->indices[(size_t) hash % ht->capacity];
+        size_t index = ht->indices[BUCKET(ht, hash)];
         while (index != NOTHING) {
             struct hash_entry *entry = &ht->entries[index];
             if (entry->hash == hash && ht->keycmp(entry->kv.key, key) == 0)
@@ -220,6 +241,48 @@ kvpair_T ht_get(const hashtable_T *ht, const void *key)
     return (kvpair_T) { NULL, NULL, };
 }
 
+/* Defines a function that works like `ht_get' for a hashtable whose keys are
+ * strings of type `chartype', where `hash' is the hash value of `key'. The
+ * generated function compares keys by calling `keycmp' directly, which is
+ * faster than calling the function stored in the hashtable. The hashtable must
+ * have been initialized with `htfunc', which must be equivalent to
+ * `keyhash'. */
+#define DEFINE_HT_GET_STRING(name, chartype, keyhash, keycmp, htfunc)         \
+kvpair_T name(const hashtable_T *ht, const chartype *key, hashval_T hash)    \
+{                                                                             \
+    assert(ht->hashfunc == htfunc);                                           \
+    if (key != NULL) {                                                        \
+        assert(hash == keyhash(key));                                         \
+        size_t index = ht->indices[BUCKET(ht, hash)];                         \
+        while (index != NOTHING) {                                            \
+            struct hash_entry *entry = &ht->entries[index];                   \
+            if (entry->hash == hash && keycmp(entry->kv.key, key) == 0)       \
+                return entry->kv;                                             \
+            index = entry->next;                                              \
+        }                                                                     \
+    }                                                                         \
+    return (kvpair_T) { NULL, NULL, };                                        \
+}
+
+DEFINE_HT_GET_STRING(ht_getstrwithhash, char, hash_mbs, strcmp, hashstr)
+DEFINE_HT_GET_STRING(ht_getwcswithhash, wchar_t, hash_wcs, wcscmp, hashwcs)
+
+#undef DEFINE_HT_GET_STRING
+
+/* Same as `ht_get' for a hashtable that uses `hashstr' and `htstrcmp'. */
+kvpair_T ht_getstr(const hashtable_T *ht, const char *key)
+{
+    return ht_getstrwithhash(ht, key, key != NULL ? hash_mbs(key) : 0);
+}
+
+/* Same as `ht_get' for a hashtable that uses `hashwcs' and `htwcscmp'.
+ * If the hash value of the key is known in advance, `ht_getwcswithhash' can be
+ * used instead to avoid computing it again. */
+kvpair_T ht_getwcs(const hashtable_T *ht, const wchar_t *key)
+{
+    return ht_getwcswithhash(ht, key, key != NULL ? hash_wcs(key) : 0);
+}
+
 /* Makes a new entry with the specified key and value,
  * removing and returning the old entry for the key.
  * If there is no such old entry, { NULL, NULL } is returned.
@@ -230,7 +293,7 @@ kvpair_T ht_set(hashtable_T *ht, const void *key, const void *value)
 
     /* if there is an entry with the specified key, simply replace the value */
     hashval_T hash = ht->hashfunc(key);
-    size_t mhash = (size_t) hash % ht->capacity;
+    size_t mhash = BUCKET(ht, hash);
     size_t index = ht->indices[mhash];
     struct hash_entry *entry;
     while (index != NOTHING) {
@@ -253,7 +316,7 @@ kvpair_T ht_set(hashtable_T *ht, const void *key, const void *value)
     } else {
         /* if there is no empty entry, use a tail entry */
         ht_ensurecapacity(ht, ht->count + 1);
-        mhash = (size_t) hash % ht->capacity;
+        mhash = BUCKET(ht, hash);
         index = ht->tailindex++;
         entry = &ht->entries[index];
     }
@@ -274,7 +337,7 @@ kvpair_T ht_remove(hashtable_T *ht, const void *key)
 {
     if (key != NULL) {
         hashval_T hash = ht->hashfunc(key);
-        size_t *indexp = &ht->indices[(size_t) hash % ht->capacity];
+        size_t *indexp = &ht->indices[BUCKET(ht, hash)];
         while (*indexp != NOTHING) {
             size_t index = *indexp;
             struct hash_entry *entry = &ht->entries[index];
@@ -356,18 +419,40 @@ kvpair_T *ht_tokvarray(const hashtable_T *ht)
 }
 
 
+/* Half the number of bits in a hash value */
+#define HASHSHIFT (sizeof (hashval_T) * CHAR_BIT / 2)
+
+/* Computes a hash value of the specified byte string.
+ * Each character is mixed in by a multiplication, which only propagates bits
+ * upward, so the final xor-shift folds the upper bits into the lower bits that
+ * are used to choose a bucket. */
+hashval_T hash_mbs(const char *s)
+{
+    const unsigned char *c = (const unsigned char *) s;
+    hashval_T h = 0;
+    while (*c != '\0')
+        h = (h ^ (hashval_T) *c++) * HASHMULT;
+    return h ^ (h >> HASHSHIFT);
+}
+
+/* Computes a hash value of the specified wide string in the same way as
+ * `hash_mbs'. */
+hashval_T hash_wcs(const wchar_t *s)
+{
+    hashval_T h = 0;
+    while (*s != L'\0')
+        h = (h ^ (hashval_T) *s++) * HASHMULT;
+    return h ^ (h >> HASHSHIFT);
+}
+
+#undef HASHSHIFT
+
 /* A hash function for a byte string.
  * The argument is a pointer to a byte string (const char *).
  * You can use `htstrcmp' as a corresponding comparison function. */
 hashval_T hashstr(const void *s)
 {
-    /* The hashing algorithm is FNV hash.
-     * Cf. http://www.isthe.com/chongo/tech/comp/fnv/ */
-    const unsigned char *c = s;
-    hashval_T h = 0;
-    while (*c != '\0')
-        h = (h ^ (hashval_T) *c++) * FNVPRIME;
-    return h;
+    return hash_mbs(s);
 }
 
 /* A hash function for a wide string.
@@ -375,13 +460,7 @@ hashval_T hashstr(const void *s)
  * You can use `htwcscmp' for a corresponding comparison function. */
 hashval_T hashwcs(const void *s)
 {
-    /* The hashing algorithm is a slightly modified version of FNV hash.
-     * Cf. http://www.isthe.com/chongo/tech/comp/fnv/ */
-    const wchar_t *c = s;
-    hashval_T h = 0;
-    while (*c != L'\0')
-        h = (h ^ (hashval_T) *c++) * FNVPRIME;
-    return h;
+    return hash_wcs(s);
 }
 
 /* A comparison function for wide strings.
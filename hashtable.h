@@ -19,19 +19,21 @@
 #ifndef YASH_HASHTABLE_H
 #define YASH_HASHTABLE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 
 #if defined UINT64_MAX && UINT64_MAX == UINT_FAST32_MAX
 typedef uint64_t hashval_T;
-# define FNVPRIME 1099511628211
+# define HASHMULT ((hashval_T) 0x9E3779B97F4A7C15)
 #elif defined UINT128_MAX && UINT128_MAX == UINT_FAST32_MAX
 typedef uint128_t hashval_T;
-# define FNVPRIME 309485009821345068724781371
+# define HASHMULT \
+    ((hashval_T) 0x9E3779B97F4A7C15 << 64 | (hashval_T) 0xF39CC0605CEDC835)
 #else
 typedef uint32_t hashval_T;
-# define FNVPRIME 16777619
+# define HASHMULT ((hashval_T) 0x9E3779B9)
 #endif
 
 /* The type of hash functions.
@@ -71,6 +73,13 @@ extern hashtable_T *ht_clear(hashtable_T *ht, void freer(kvpair_T kv))
     __attribute__((nonnull(1)));
 extern kvpair_T ht_get(const hashtable_T *ht, const void *key)
     __attribute__((nonnull(1)));
+extern kvpair_T ht_getstr(const hashtable_T *ht, const char *key)
+    __attribute__((nonnull(1)));
+extern kvpair_T ht_getwcs(const hashtable_T *ht, const wchar_t *key)
+    __attribute__((nonnull(1)));
+extern kvpair_T ht_getwcswithhash(
+        const hashtable_T *ht, const wchar_t *key, hashval_T hash)
+    __attribute__((nonnull(1)));
 extern kvpair_T ht_set(hashtable_T *ht, const void *key, const void *value)
     __attribute__((nonnull(1,2)));
 extern kvpair_T ht_remove(hashtable_T *ht, const void *key)
@@ -96,7 +105,7 @@ extern void kvfree(kvpair_T kv);
 
 
 #ifndef HASHTABLE_DEFAULT_INIT_CAPACITY
-#define HASHTABLE_DEFAULT_INIT_CAPACITY 5
+#define HASHTABLE_DEFAULT_INIT_CAPACITY 8
 #endif
 
 /* Initializes the specified hashtable with the default capacity.
@@ -20,6 +20,7 @@
 #include "job.h"
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #if HAVE_GETTEXT
 # include <libintl.h>
 #endif
@@ -30,17 +31,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 #include <wchar.h>
 #include <wctype.h>
 #include "builtin.h"
 #include "exec.h"
 #include "option.h"
+#include "parser.h"
 #include "plist.h"
 #include "redir.h"
 #include "sig.h"
 #include "strbuf.h"
 #include "util.h"
+#include "variable.h"
 #include "yash.h"
 #if YASH_ENABLE_LINEEDIT
 # include "xfnmatch.h"
@@ -1391,6 +1395,190 @@ const char wait_syntax[] = Ngt(
 );
 #endif
 
+#ifdef CLOCK_MONOTONIC
+# define WAITANY_CLOCK CLOCK_MONOTONIC
+#else
+# define WAITANY_CLOCK CLOCK_REALTIME
+#endif
+
+/* Options for the "waitany" built-in. */
+const struct xgetopt_T waitany_options[] = {
+    { L't', L"timeout",  OPTARG_REQUIRED, false, NULL, },
+    { L'v', L"variable", OPTARG_REQUIRED, false, NULL, },
+#if YASH_ENABLE_HELP
+    { L'-', L"help",     OPTARG_NONE,     false, NULL, },
+#endif
+    { L'\0', NULL, 0, false, NULL, },
+};
+
+/* The "waitany" built-in, which accepts the following options:
+ *  -t: maximum number of seconds to wait
+ *  -v: name of the array to assign the ready operands to
+ * Each operand is a file descriptor or a job specification beginning with
+ * '%'. The built-in waits until any of the file descriptors is available for
+ * reading or any of the jobs is no longer running, and then prints the ready
+ * operands (or assigns them to the array). */
+int waitany_builtin(int argc, void **argv)
+{
+    const wchar_t *timeoutstr = NULL, *varname = NULL;
+
+    const struct xgetopt_T *opt;
+    xoptind = 0;
+    while ((opt = xgetopt(argv, waitany_options, 0)) != NULL) {
+        switch (opt->shortopt) {
+            case L't':
+                timeoutstr = xoptarg;
+                break;
+            case L'v':
+                varname = xoptarg;
+                break;
+#if YASH_ENABLE_HELP
+            case L'-':
+                return print_builtin_help(ARGV(0));
+#endif
+            default:
+                return Exit_ERROR;
+        }
+    }
+
+    if (xoptind == argc)
+        return insufficient_operands_error(1);
+
+    int timeout = -1;
+    if (timeoutstr != NULL) {
+        wchar_t *end;
+        errno = 0;
+        double seconds = wcstod(timeoutstr, &end);
+        if (timeoutstr[0] == L'\0' || *end != L'\0' || errno != 0
+                || !(seconds >= 0.0 && seconds <= INT_MAX / 1000)) {
+            xerror(0, Ngt("`%ls' is not a valid number"), timeoutstr);
+            return Exit_ERROR;
+        }
+        timeout = (int) (seconds * 1000.0);
+    }
+    if (varname != NULL && !is_name(varname)) {
+        xerror(0, Ngt("`%ls' is not a valid variable name"), varname);
+        return Exit_ERROR;
+    }
+
+    /* parse the operands */
+    size_t opcount = argc - xoptind;
+    void **operands = &argv[xoptind];
+    int fds[opcount];
+    size_t fdops[opcount], jobnumbers[opcount], jobops[opcount];
+    size_t fdcount = 0, jobcount = 0;
+    for (size_t i = 0; i < opcount; i++) {
+        const wchar_t *operand = operands[i];
+        if (operand[0] == L'%') {
+            size_t jobnumber = get_jobnumber_from_name(&operand[1]);
+            if (jobnumber >= joblist.length) {
+                xerror(0, Ngt("job specification `%ls' is ambiguous"),
+                        operand);
+                return Exit_ERROR;
+            }
+            job_T *job;
+            if (jobnumber == 0
+                    || (job = joblist.contents[jobnumber]) == NULL
+                    || job->j_legacy) {
+                xerror(0, Ngt("no such job `%ls'"), operand);
+                return Exit_ERROR;
+            }
+            jobnumbers[jobcount] = jobnumber;
+            jobops[jobcount++] = i;
+        } else {
+            long fd;
+            if (!xwcstol(operand, 10, &fd) || fd < 0 || fd > INT_MAX) {
+                xerror(0, Ngt("`%ls' is not a valid integer"), operand);
+                return Exit_ERROR;
+            }
+            fds[fdcount] = (int) fd;
+            fdops[fdcount++] = i;
+        }
+    }
+
+    struct timespec deadline;
+    if (timeout > 0) {
+        clock_gettime(WAITANY_CLOCK, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += timeout % 1000 * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    bool ready[opcount], fdready[fdcount + 1];
+    bool expired = false;
+    for (;;) {
+        bool anyready = false;
+        for (size_t i = 0; i < jobcount; i++) {
+            job_T *job = joblist.contents[jobnumbers[i]];
+            ready[jobops[i]] = (job == NULL || job->j_status != JS_RUNNING);
+            if (ready[jobops[i]])
+                anyready = true;
+        }
+        if (!anyready && expired)
+            return Exit_FAILURE;
+
+        int wait = timeout;
+        if (anyready) {
+            wait = 0;
+        } else if (timeout > 0) {
+            struct timespec now;
+            clock_gettime(WAITANY_CLOCK, &now);
+            long long remaining =
+                (long long) (deadline.tv_sec - now.tv_sec) * 1000
+                + (deadline.tv_nsec - now.tv_nsec) / 1000000;
+            wait = (remaining > 0) ? (int) remaining : 0;
+        }
+
+        int signal = wait_for_inputs_or_sigchld(fdcount, fds, fdready,
+                wait, doing_job_control_now, true);
+        if (signal < 0)
+            return Exit_ERROR;
+        if (signal > 0) {
+            assert(TERMSIGOFFSET >= 128);
+            return signal + TERMSIGOFFSET;
+        }
+
+        for (size_t i = 0; i < fdcount; i++) {
+            ready[fdops[i]] = fdready[i];
+            if (fdready[i])
+                anyready = true;
+        }
+        if (anyready)
+            break;
+        expired = (wait == 0);
+    }
+
+    if (varname != NULL) {
+        plist_T list;
+        pl_init(&list);
+        for (size_t i = 0; i < opcount; i++)
+            if (ready[i])
+                pl_add(&list, xwcsdup(operands[i]));
+        size_t count = list.length;
+        if (set_array(varname, count, pl_toary(&list), SCOPE_GLOBAL, false)
+                == NULL)
+            return Exit_FAILURE;
+    } else {
+        for (size_t i = 0; i < opcount; i++)
+            if (ready[i])
+                if (!xprintf("%ls\n", (const wchar_t *) operands[i]))
+                    return Exit_FAILURE;
+    }
+    return Exit_SUCCESS;
+}
+
+#if YASH_ENABLE_HELP
+const char waitany_help[] = Ngt(
+"wait for file descriptors or jobs to become ready"
+);
+const char waitany_syntax[] = Ngt(
+"\twaitany [-t timeout] [-v array] file_descriptor_or_job...\n"
+);
+#endif
+
 /* The "disown" built-in, which accepts the following option:
  *  -a: disown all jobs */
 int disown_builtin(int argc, void **argv)
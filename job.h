@@ -118,6 +118,13 @@ extern int wait_builtin(int argc, void **argv)
 extern const char wait_help[], wait_syntax[];
 #endif
 
+extern int waitany_builtin(int argc, void **argv)
+    __attribute__((nonnull));
+#if YASH_ENABLE_HELP
+extern const char waitany_help[], waitany_syntax[];
+#endif
+extern const struct xgetopt_T waitany_options[];
+
 extern int disown_builtin(int argc, void **argv)
     __attribute__((nonnull));
 #if YASH_ENABLE_HELP
@@ -19,7 +19,6 @@
 #include "../common.h"
 #include "complete.h"
 #include <assert.h>
-#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #if HAVE_GETGRENT
@@ -42,7 +41,9 @@
 #include <string.h>
 #include <wchar.h>
 #include <wctype.h>
-#include <sys/stat.h>
+#include <sys/select.h>
+#include <sys/times.h>
+#include <unistd.h>
 #include "../builtin.h"
 #include "../exec.h"
 #include "../expand.h"
@@ -111,7 +112,12 @@ static void select_candidate_by_offset(int offset);
 static void free_candidate(void *c)
     __attribute__((nonnull));
 static void free_context(le_context_T *ctxt);
+struct sortkey_T;
 static void sort_candidates(void);
+static void make_sort_key(struct sortkey_T *key, le_candidate_T *cand)
+    __attribute__((nonnull));
+static wchar_t *xwcsxfrm(const wchar_t *s)
+    __attribute__((nonnull,malloc,warn_unused_result));
 static int sort_candidates_cmp(const void *cp1, const void *cp2)
     __attribute__((nonnull));
 static void print_context_info(const le_context_T *ctxt)
@@ -119,9 +125,23 @@ static void print_context_info(const le_context_T *ctxt)
 static void print_compopt_info(const le_compopt_T *compopt)
     __attribute__((nonnull));
 
+static void start_cancellation_check(void);
+static bool completion_cancelled(void);
+static bool has_pending_input(void);
+static long milliseconds_since(clock_t start);
+
 static void execute_completion_function(void);
+static bool call_completion_function_cached(const wchar_t *funcname)
+    __attribute__((nonnull));
 static void complete_command_default(void);
 
+static bool use_cached_candidates(void);
+static bool cache_is_applicable(void);
+static void cache_candidates(void);
+static le_candidate_T *copy_candidate(const le_candidate_T *cand)
+    __attribute__((nonnull,malloc,warn_unused_result));
+static long get_cache_timeout(void);
+
 static void simple_completion(le_candgentype_T type);
 static void generate_candidates(const le_compopt_T *compopt)
     __attribute__((nonnull));
@@ -173,6 +193,22 @@ size_t le_selected_candidate_index;
  * The value is ((size_t) -1) when not computed. */
 static size_t common_prefix_length;
 
+/* The time (in clock ticks as returned by `times') when the current completion
+ * started. */
+static clock_t completion_start_time;
+/* True if the current completion has been cancelled. */
+static bool cancelled;
+/* Counter to reduce the frequency of checks in `completion_cancelled'. */
+static unsigned cancellation_check_count;
+
+/* Candidates generated by the last call to a completion function and the
+ * context in which they were generated. */
+static struct {
+    le_context_T *ctxt;
+    plist_T candidates;
+    clock_t time;    // when the candidates were generated
+} compcache = { .ctxt = NULL, };
+
 
 /* Performs command line completion.
  * Existing candidates are deleted, if any, and candidates are computed from
@@ -199,17 +235,28 @@ void le_complete(le_compresult_T lecr)
     le_complete_cleanup();
     pl_init(&le_candidates);
     common_prefix_length = (size_t) -1;
+    start_cancellation_check();
+    freeze_directory_index(true);
 
     ctxt = le_get_context();
     if (le_state_is_compdebug)
         print_context_info(ctxt);
 
     execute_completion_function();
-    sort_candidates();
-    le_compdebug("total of %zu candidate(s)", le_candidates.length);
 
-    /* display the results */
-    lecr();
+    if (completion_cancelled()) {
+        /* The result is stale as the user has typed ahead. */
+        le_compdebug("completion cancelled by pending input");
+        le_complete_cleanup();
+    } else {
+        sort_candidates();
+        le_compdebug("total of %zu candidate(s)", le_candidates.length);
+
+        /* display the results */
+        lecr();
+    }
+
+    freeze_directory_index(false);
 
     if (le_state_is_compdebug) {
         le_compdebug("completion end");
@@ -414,54 +461,180 @@ void free_context(le_context_T *ctxt)
     }
 }
 
+/* A candidate paired with the keys used in sorting.
+ * The keys are computed once for each candidate before sorting so that the
+ * comparison function does not have to call `wcscoll' or `wcscasecmp'. */
+struct sortkey_T {
+    le_candidate_T *cand;
+    size_t hyphens;     // number of leading hyphens in the value
+#if HAVE_WCSCASECMP
+    wchar_t *folded;    // value after the hyphens converted to lowercase
+#endif
+    wchar_t *collkey;   // collation key of the value after the hyphens
+};
+
 /* Sorts the candidates in the candidate list and removes duplicates. */
 void sort_candidates(void)
 {
-    qsort(le_candidates.contents,
-            le_candidates.length, sizeof *le_candidates.contents,
-            sort_candidates_cmp);
-
-    if (le_candidates.length >= 2) {
-        for (size_t i = le_candidates.length - 1; i > 0; i--) {
-            le_candidate_T *cand1 = le_candidates.contents[i];
-            le_candidate_T *cand2 = le_candidates.contents[i - 1];
-            // XXX case-sensitive
-            if (wcscoll(cand1->origvalue, cand2->origvalue) == 0) {
-                free_candidate(cand1);
-                pl_remove(&le_candidates, i, 1);
-            }
+    size_t count = le_candidates.length;
+    if (count == 0)
+        return;
+
+    struct sortkey_T *keys = xmallocn(count, sizeof *keys);
+    for (size_t i = 0; i < count; i++)
+        make_sort_key(&keys[i], le_candidates.contents[i]);
+
+    qsort(keys, count, sizeof *keys, sort_candidates_cmp);
+
+    /* Remove duplicates in one pass. Duplicates are adjacent after sorting. */
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        // XXX case-sensitive
+        if (n > 0 && keys[i].hyphens == keys[n - 1].hyphens &&
+                wcscmp(keys[i].collkey, keys[n - 1].collkey) == 0) {
+            free_candidate(keys[i].cand);
+#if HAVE_WCSCASECMP
+            free(keys[i].folded);
+#endif
+            free(keys[i].collkey);
+        } else {
+            keys[n++] = keys[i];
         }
     }
+
+    for (size_t i = 0; i < n; i++) {
+        le_candidates.contents[i] = keys[i].cand;
+#if HAVE_WCSCASECMP
+        free(keys[i].folded);
+#endif
+        free(keys[i].collkey);
+    }
+    pl_truncate(&le_candidates, n);
+    free(keys);
+}
+
+/* Initializes `key' for the specified candidate. */
+void make_sort_key(struct sortkey_T *key, le_candidate_T *cand)
+{
+    const wchar_t *v = cand->origvalue;
+    size_t hyphens = wcsspn(v, L"-");
+
+    key->cand = cand;
+    key->hyphens = hyphens;
+    v += hyphens;
+#if HAVE_WCSCASECMP
+    if (hyphens > 0) {
+        wchar_t *folded = xwcsdup(v);
+        for (wchar_t *f = folded; *f != L'\0'; f++)
+            *f = towlower(*f);
+        key->folded = folded;
+    } else {
+        key->folded = NULL;
+    }
+#endif
+    key->collkey = xwcsxfrm(v);
+}
+
+/* Returns a newly malloced collation key for the specified string. Comparing
+ * keys with `wcscmp' is equivalent to comparing the strings with `wcscoll'. */
+wchar_t *xwcsxfrm(const wchar_t *s)
+{
+    size_t len = wcsxfrm(NULL, s, 0);
+    if (len == (size_t) -1)
+        return xwcsdup(s);
+
+    wchar_t *key = xmalloce(len, 1, sizeof *key);
+    wcsxfrm(key, s, len + 1);
+    return key;
 }
 
 int sort_candidates_cmp(const void *cp1, const void *cp2)
 {
-    const le_candidate_T *cand1 = *(const le_candidate_T **) cp1;
-    const le_candidate_T *cand2 = *(const le_candidate_T **) cp2;
-    const wchar_t *v1 = cand1->origvalue;
-    const wchar_t *v2 = cand2->origvalue;
+    const struct sortkey_T *key1 = cp1;
+    const struct sortkey_T *key2 = cp2;
 
     /* Candidates that start with hyphens are sorted in a special order so that
      * short options come before long options. Such candidates are sorted case-
      * insensitively. */
-    if (v1[0] == L'-' || v2[0] == L'-') {
-        while (*v1 == L'-' && *v2 == L'-')
-            v1++, v2++;
-        if (*v1 == L'-')
-            return 1;
-        if (*v2 == L'-')
-            return -1;
+    if (key1->hyphens != key2->hyphens)
+        return key1->hyphens < key2->hyphens ? -1 : 1;
 #if HAVE_WCSCASECMP
-        int cmp = wcscasecmp(v1, v2);
+    if (key1->hyphens > 0) {
+        int cmp = wcscmp(key1->folded, key2->folded);
         if (cmp != 0)
             return cmp;
-#endif
     }
+#endif
 
-    return wcscoll(v1, v2);
+    return wcscmp(key1->collkey, key2->collkey);
     // XXX case-sensitive
 }
 
+/* The time in milliseconds after which pending input cancels completion. */
+#define CANCEL_DELAY 100
+/* The number of calls to `completion_cancelled' between checks. */
+#define CANCEL_CHECK_INTERVAL 64
+
+/* Starts measuring the time for `completion_cancelled'. */
+void start_cancellation_check(void)
+{
+    struct tms tms;
+    completion_start_time = times(&tms);
+    cancelled = false;
+    cancellation_check_count = 0;
+}
+
+/* Checks if the current completion should be cancelled.
+ * If candidate generation has been taking longer than CANCEL_DELAY and the
+ * user has typed something meanwhile, the generation is cancelled so that a
+ * slow generator does not freeze the editor. Once this function returned true,
+ * it keeps returning true until the end of the current completion.
+ * Completion is never cancelled in the `le-compdebug' mode. */
+bool completion_cancelled(void)
+{
+    if (cancelled)
+        return true;
+    if (le_state_is_compdebug)
+        return false;
+    if (cancellation_check_count++ % CANCEL_CHECK_INTERVAL != 0)
+        return false;
+    if (milliseconds_since(completion_start_time) < CANCEL_DELAY)
+        return false;
+
+    cancelled = has_pending_input();
+    return cancelled;
+}
+
+/* Checks if the standard input has input that can be read without blocking. */
+bool has_pending_input(void)
+{
+    fd_set fds;
+    struct timeval timeout = { .tv_sec = 0, .tv_usec = 0, };
+
+    if (STDIN_FILENO >= FD_SETSIZE)
+        return false;
+    FD_ZERO(&fds);
+    FD_SET(STDIN_FILENO, &fds);
+    return select(STDIN_FILENO + 1, &fds, NULL, NULL, &timeout) > 0;
+}
+
+/* Returns the time in milliseconds elapsed since `start', which must be a value
+ * returned from `times'. Returns -1 if the time is unknown. */
+long milliseconds_since(clock_t start)
+{
+    static long ticks_per_second = 0;
+    if (ticks_per_second == 0)
+        ticks_per_second = sysconf(_SC_CLK_TCK);
+    if (ticks_per_second <= 0)
+        return -1;
+
+    struct tms tms;
+    clock_t now = times(&tms);
+    if (now == (clock_t) -1 || start == (clock_t) -1)
+        return -1;
+    return (now - start) * 1000 / ticks_per_second;
+}
+
 /* Prints the formatted string to the standard error if the completion debugging
  * option is on.
  * The string is preceded by "[compdebug] " and followed by a newline. */
@@ -568,11 +741,11 @@ void execute_completion_function(void)
             simple_completion(CGT_FILE);
             break;
         case CTXT_COMMAND:
-            if (!call_completion_function(L"" COMMAND_COMPFUNC))
+            if (!call_completion_function_cached(L"" COMMAND_COMPFUNC))
                 complete_command_default();
             break;
         case CTXT_ARGUMENT:
-            if (!call_completion_function(L"" ARGUMENT_COMPFUNC))
+            if (!call_completion_function_cached(L"" ARGUMENT_COMPFUNC))
                 simple_completion(CGT_FILE);
             break;
         case CTXT_TILDE:
@@ -602,6 +775,22 @@ void execute_completion_function(void)
 
 }
 
+/* Like `call_completion_function', but reuses the candidates generated by the
+ * previous call if possible.
+ * Returns false iff the completion function was not found. */
+bool call_completion_function_cached(const wchar_t *funcname)
+{
+    if (use_cached_candidates())
+        return true;
+
+    if (!call_completion_function(funcname))
+        return false;
+
+    if (!completion_cancelled())
+        cache_candidates();
+    return true;
+}
+
 /* Sets special local variables $WORDS and $TARGETWORD in the current variable
  * environment. Also sets the $IFS variable to the default value. */
 void set_completion_variables(void)
@@ -652,6 +841,137 @@ void complete_command_default(void)
 }
 
 
+/********** Completion Result Cache **********/
+
+/* Completion functions may take a long time to generate candidates, especially
+ * when they run external commands. When the user presses Tab again after
+ * typing some more characters of the same word, the candidates generated by the
+ * previous call are filtered and reused instead of calling the function again.
+ * The cache expires after $YASH_LE_COMPCACHE_TIMEOUT milliseconds and whenever
+ * line-editing is finished. */
+
+/* Adds the candidates in the cache that match the current source word to the
+ * candidate list if the cache is applicable to the current context.
+ * Returns true iff the cached candidates have been used. */
+bool use_cached_candidates(void)
+{
+    if (!cache_is_applicable())
+        return false;
+
+    size_t oldcount = le_candidates.length;
+    size_t srclen = wcslen(ctxt->src);
+    for (size_t i = 0; i < compcache.candidates.length; i++) {
+        const le_candidate_T *cand = compcache.candidates.contents[i];
+        if (wcsncmp(cand->origvalue, ctxt->src, srclen) == 0)
+            pl_add(&le_candidates, copy_candidate(cand));
+    }
+
+    /* The completion function may generate different kinds of candidates if
+     * the previous ones do not match, so we don't trust an empty result. */
+    if (le_candidates.length == oldcount)
+        return false;
+
+    le_compdebug("reused %zu cached candidate(s)",
+            le_candidates.length - oldcount);
+    return true;
+}
+
+/* Checks if the cached candidates can be used in the current completion.
+ * The cache is applicable if it has not expired, the words preceding the source
+ * word are the same, and the source word has been extended only with
+ * alphanumeric characters. Other characters like hyphens, slashes, and equal
+ * signs may make the completion function generate another kind of candidates.
+ */
+bool cache_is_applicable(void)
+{
+    const le_context_T *old = compcache.ctxt;
+    if (old == NULL)
+        return false;
+    if (old->quote != ctxt->quote || old->type != ctxt->type)
+        return false;
+    if (old->substsrc || ctxt->substsrc)
+        return false;
+    if (old->pwordc != ctxt->pwordc)
+        return false;
+    for (int i = 0; i < ctxt->pwordc; i++)
+        if (wcscmp(old->pwords[i], ctxt->pwords[i]) != 0)
+            return false;
+
+    const wchar_t *added = matchwcsprefix(ctxt->src, old->src);
+    if (added == NULL)
+        return false;
+    for (; *added != L'\0'; added++)
+        if (!iswalnum(*added) && *added != L'_')
+            return false;
+
+    long elapsed = milliseconds_since(compcache.time);
+    return 0 <= elapsed && elapsed < get_cache_timeout();
+}
+
+/* Replaces the cache with copies of the current candidates. */
+void cache_candidates(void)
+{
+    le_complete_clear_cache();
+    if (get_cache_timeout() <= 0)
+        return;
+
+    le_context_T *c = xmalloc(sizeof *c);
+    *c = *ctxt;
+    c->pwords = pldup(ctxt->pwords, copyaswcs);
+    c->src = xwcsdup(ctxt->src);
+    c->pattern = xwcsdup(ctxt->pattern);
+    compcache.ctxt = c;
+
+    pl_initwithmax(&compcache.candidates, le_candidates.length);
+    for (size_t i = 0; i < le_candidates.length; i++)
+        pl_add(&compcache.candidates,
+                copy_candidate(le_candidates.contents[i]));
+
+    struct tms tms;
+    compcache.time = times(&tms);
+}
+
+/* Returns a newly malloced copy of the specified candidate. */
+le_candidate_T *copy_candidate(const le_candidate_T *cand)
+{
+    le_candidate_T *copy = xmalloc(sizeof *copy);
+    *copy = *cand;
+    copy->origvalue = xwcsdup(cand->origvalue);
+    copy->value = &copy->origvalue[cand->value - cand->origvalue];
+    copy->rawvalue.raw = NULL;
+    copy->desc = (cand->desc != NULL) ? xwcsdup(cand->desc) : NULL;
+    copy->rawdesc.raw = NULL;
+    return copy;
+}
+
+/* Returns the lifetime of the cache in milliseconds.
+ * The value is taken from the $YASH_LE_COMPCACHE_TIMEOUT variable. */
+long get_cache_timeout(void)
+{
+#ifndef LE_COMPCACHE_TIMEOUT_DEFAULT
+#define LE_COMPCACHE_TIMEOUT_DEFAULT 3000
+#endif
+
+    const wchar_t *v = getvar(L VAR_YASH_LE_COMPCACHE_TIMEOUT);
+    if (v != NULL) {
+        long l;
+        if (xwcstol(v, 0, &l))
+            return l;
+    }
+    return LE_COMPCACHE_TIMEOUT_DEFAULT;
+}
+
+/* Discards the cached candidates. */
+void le_complete_clear_cache(void)
+{
+    if (compcache.ctxt != NULL) {
+        plfree(pl_toary(&compcache.candidates), free_candidate);
+        free_context(compcache.ctxt);
+        compcache.ctxt = NULL;
+    }
+}
+
+
 /********** Completion Candidate Generation **********/
 
 /* Perform completion for the specified candidate type(s). */
@@ -679,20 +999,28 @@ void simple_completion(le_candgentype_T type)
  * set to NULL. */
 void generate_candidates(const le_compopt_T *compopt)
 {
-    generate_file_candidates(compopt);
-    generate_builtin_candidates(compopt);
-    generate_external_command_candidates(compopt);
-    generate_function_candidates(compopt);
-    generate_keyword_candidates(compopt);
-    generate_alias_candidates(compopt);
-    generate_variable_candidates(compopt);
-    generate_job_candidates(compopt);
-    generate_signal_candidates(compopt);
-    generate_logname_candidates(compopt);
-    generate_group_candidates(compopt);
-    generate_host_candidates(compopt);
-    generate_bindkey_candidates(compopt);
-    generate_dirstack_candidates(compopt);
+    static void (*const generators[])(const le_compopt_T *compopt) = {
+        generate_file_candidates,
+        generate_builtin_candidates,
+        generate_external_command_candidates,
+        generate_function_candidates,
+        generate_keyword_candidates,
+        generate_alias_candidates,
+        generate_variable_candidates,
+        generate_job_candidates,
+        generate_signal_candidates,
+        generate_logname_candidates,
+        generate_group_candidates,
+        generate_host_candidates,
+        generate_bindkey_candidates,
+        generate_dirstack_candidates,
+    };
+
+    for (size_t i = 0; i < sizeof generators / sizeof *generators; i++) {
+        if (completion_cancelled())
+            break;
+        generators[i](compopt);
+    }
 
     for (const le_comppattern_T *p = compopt->patterns; p != NULL; p = p->next)
         xfnm_free(p->cpattern);
@@ -735,9 +1063,16 @@ void le_new_candidate(le_candtype_T type, wchar_t *value, wchar_t *desc,
  * the `origvalue' and `terminate' members, which are initialized in this
  * function.
  * This function treats the prefix and suffix specified in the "complete"
- * built-in invocation. */
+ * built-in invocation.
+ * If the completion has been cancelled, the candidate is just freed. */
 void le_add_candidate(le_candidate_T *cand, const le_compopt_T *compopt)
 {
+    if (completion_cancelled()) {
+        cand->origvalue = cand->value;
+        free_candidate(cand);
+        return;
+    }
+
     xwcsbuf_T buf;
     wb_initwith(&buf, cand->value);
 
@@ -749,7 +1084,7 @@ void le_add_candidate(le_candidate_T *cand, const le_compopt_T *compopt)
 
     /* append suffix */
     bool allowterminate = true;
-    if ((cand->type == CT_FILE) && S_ISDIR(cand->appendage.filestat.mode) &&
+    if ((cand->type == CT_FILE) && cand->appendage.filestat.is_directory &&
             !(compopt->type & CGT_DIRECTORY)) {
         wb_wccat(&buf, L'/');
         allowterminate = false;
@@ -873,7 +1208,7 @@ void generate_file_candidates(const le_compopt_T *compopt)
     if (!le_compile_cpatterns(compopt))
         return;
 
-    enum wglobflags_T flags = 0;
+    enum wglobflags_T flags = WGLB_MARK;
     // if (shopt_nocaseglob)   flags |= WGLB_CASEFOLD;  XXX case-sensitive
     if (shopt_dotglob)      flags |= WGLB_PERIOD;
     if (shopt_extendedglob) flags |= WGLB_RECDIR;
@@ -881,6 +1216,12 @@ void generate_file_candidates(const le_compopt_T *compopt)
     const le_comppattern_T *p = compopt->patterns;
     assert(p->type == CPT_ACCEPT);
 
+    /* If the last component of the pattern is a literal, wglob does not mark
+     * directories, so we have to check the results ourselves. */
+    const wchar_t *lastcomponent = wcsrchr(p->pattern, L'/');
+    bool marked = is_matching_pattern(
+            (lastcomponent != NULL) ? &lastcomponent[1] : p->pattern);
+
     /* generate candidates by wglob */
     plist_T list;
     wglob(p->pattern, flags, pl_init(&list));
@@ -889,6 +1230,13 @@ void generate_file_candidates(const le_compopt_T *compopt)
     /* check pathnames in `list' and add them to the candidate list */
     for (size_t i = 0; i < list.length; i++) {
         wchar_t *name = list.contents[i];
+
+        /* wglob has appended a slash to directory names */
+        size_t namelength = wcslen(name);
+        bool isdir = namelength > 1 && name[namelength - 1] == L'/';
+        if (isdir)
+            name[namelength - 1] = L'\0';
+
         if (p != NULL) {
             const wchar_t *basename = wcsrchr(name, L'/');
             if (basename == NULL)
@@ -899,30 +1247,34 @@ void generate_file_candidates(const le_compopt_T *compopt)
             }
         }
 
-        char *mbsname = malloc_wcstombs(name);
-        struct stat st;
-        if (mbsname != NULL &&
-                (stat(mbsname, &st) >= 0 || lstat(mbsname, &st) >= 0)) {
-            bool executable = S_ISREG(st.st_mode) && is_executable(mbsname);
-            if ((compopt->type & CGT_FILE)
-                    || ((compopt->type & CGT_DIRECTORY) && S_ISDIR(st.st_mode))
-                    || ((compopt->type & CGT_EXECUTABLE) && executable)) {
-                le_candidate_T *cand = xmalloc(sizeof *cand);
-                cand->type = CT_FILE;
-                cand->value = name;
-                cand->rawvalue.raw = NULL;
-                cand->rawvalue.width = 0;
-                cand->desc = NULL;
-                cand->rawdesc.raw = NULL;
-                cand->rawdesc.width = 0;
-                cand->appendage.filestat.is_executable = executable;
-                cand->appendage.filestat.mode = st.st_mode;
-                cand->appendage.filestat.nlink = st.st_nlink;
-                cand->appendage.filestat.size = st.st_size;
-                le_add_candidate(cand, compopt);
-                name = NULL;
-            }
+        /* We avoid `stat'ing the file unless its type really matters. */
+        char *mbsname = NULL;
+        if (!isdir && !marked) {
+            mbsname = malloc_wcstombs(name);
+            isdir = mbsname != NULL && is_directory(mbsname);
         }
+        if (!(compopt->type & CGT_FILE)
+                && !((compopt->type & CGT_DIRECTORY) && isdir)) {
+            if (!(compopt->type & CGT_EXECUTABLE) || isdir)
+                goto skip;
+            if (mbsname == NULL)
+                mbsname = malloc_wcstombs(name);
+            if (mbsname == NULL || !is_executable_regular(mbsname))
+                goto skip;
+        }
+
+        le_candidate_T *cand = xmalloc(sizeof *cand);
+        cand->type = CT_FILE;
+        cand->value = name;
+        cand->rawvalue.raw = NULL;
+        cand->rawvalue.width = 0;
+        cand->desc = NULL;
+        cand->rawdesc.raw = NULL;
+        cand->rawdesc.width = 0;
+        cand->appendage.filestat.is_directory = isdir;
+        le_add_candidate(cand, compopt);
+        name = NULL;
+skip:
         free(name);
         free(mbsname);
     }
@@ -943,35 +1295,34 @@ void generate_external_command_candidates(const le_compopt_T *compopt)
         return;
 
     char *const *paths = get_path_array(PA_PATH);
-    xstrbuf_T path;
-
     if (paths == NULL)
         return;
-    sb_init(&path);
+
+    /* Every candidate must match the first pattern, so only the names that
+     * start with the literal head of the pattern need to be tested. */
+    assert(compopt->patterns->type == CPT_ACCEPT);
+    const wchar_t *pattern = compopt->patterns->pattern;
+    char *prefix = malloc_wcsntombs(pattern, wcscspn(pattern, L"*?[\\"));
+    if (prefix == NULL)
+        prefix = xstrdup("");
+    size_t prefixlen = strlen(prefix);
+
     for (const char *dirpath; (dirpath = *paths) != NULL; paths++) {
-        DIR *dir = opendir(dirpath);
-        struct dirent *de;
-        size_t dirpathlen;
+        if (completion_cancelled())
+            break;
 
-        if (dir == NULL)
+        char *const *names = get_directory_commands(dirpath, prefix);
+        if (names == NULL)
             continue;
-        sb_cat(&path, dirpath);
-        if (path.length > 0 && path.contents[path.length - 1] != '/')
-            sb_ccat(&path, '/');
-        dirpathlen = path.length;
-        while ((de = readdir(dir)) != NULL) {
-            if (!le_match_comppatterns(compopt, de->d_name))
-                continue;
-            sb_cat(&path, de->d_name);
-            if (is_executable_regular(path.contents))
+        for (; *names != NULL; names++) {
+            if (strncmp(*names, prefix, prefixlen) != 0)
+                break;
+            if (le_match_comppatterns(compopt, *names))
                 le_new_candidate(CT_COMMAND,
-                        malloc_mbstowcs(de->d_name), NULL, compopt);
-            sb_truncate(&path, dirpathlen);
+                        malloc_mbstowcs(*names), NULL, compopt);
         }
-        sb_clear(&path);
-        closedir(dir);
     }
-    sb_destroy(&path);
+    free(prefix);
 }
 
 /* Generates candidates that are keywords matching the pattern. */
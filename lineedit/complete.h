@@ -20,7 +20,6 @@
 #define YASH_COMPLETE_H
 
 #include <stddef.h>
-#include <sys/types.h>
 #include "../plist.h"
 #include "../xgetopt.h"
 
@@ -53,10 +52,7 @@ typedef struct le_candidate_T {
     _Bool terminate;              // if completed word should be terminated
     union {
         struct {
-            _Bool is_executable;
-            mode_t mode;
-            nlink_t nlink;
-            off_t size;
+            _Bool is_directory;
         } filestat;               // only used for CT_FILE
     } appendage;
 } le_candidate_T;
@@ -195,6 +191,7 @@ extern void le_complete_select_column(int offset);
 extern void le_complete_select_page(int offset);
 extern _Bool le_complete_fix_candidate(int index);
 extern void le_complete_cleanup(void);
+extern void le_complete_clear_cache(void);
 extern void le_compdebug(const char *format, ...)
     __attribute__((nonnull,format(printf,1,2)));
 
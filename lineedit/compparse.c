@@ -839,7 +839,7 @@ wordunit_T *cparse_paramexp_raw(le_contexttype_T ctxttype)
         wu->wu_type = WT_PARAM;
         wu->wu_param = xmalloc(sizeof *wu->wu_param);
         wu->wu_param->pe_type = PT_MINUS;
-        wu->wu_param->pe_name = xwcsndup(&BUF[INDEX + 1], namelen);
+        set_paramexp_name(wu->wu_param, xwcsndup(&BUF[INDEX + 1], namelen));
         wu->wu_param->pe_start = wu->wu_param->pe_end =
         wu->wu_param->pe_match = wu->wu_param->pe_subst = NULL;
     }
@@ -920,7 +920,7 @@ wordunit_T *cparse_paramexp_in_brace(le_contexttype_T ctxttype)
             pi->ctxt->srcindex = le_main_index - namelen;
             goto return_null;
         }
-        pe->pe_name = xwcsndup(&BUF[INDEX], namelen);
+        set_paramexp_name(pe, xwcsndup(&BUF[INDEX], namelen));
         INDEX += namelen;
     }
 
@@ -1038,7 +1038,7 @@ check_closing_paren:
              * to avoid a possible "nounset" error. */
             paramexp_T *pe2 = xmalloc(sizeof *pe2);
             pe2->pe_type = PT_MINUS;
-            pe2->pe_name = pe->pe_name;
+            set_paramexp_name(pe2, pe->pe_name);
             pe2->pe_start = pe2->pe_end = pe2->pe_match = pe2->pe_subst = NULL;
 
             wordunit_T *nest = xmalloc(sizeof *nest);
@@ -19,6 +19,7 @@
 #include "../common.h"
 #include "display.h"
 #include <assert.h>
+#include <errno.h>
 #if HAVE_GETTEXT
 # include <libintl.h>
 #endif
@@ -28,6 +29,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <wchar.h>
 #include <wctype.h>
@@ -339,6 +341,9 @@ static void clear_to_end_of_screen(void);
 static void clear_editline(void);
 static void maybe_print_promptsp(void);
 static void update_editline(void);
+static bool shift_editline(size_t index);
+static int editline_width(const wchar_t *s, size_t n)
+    __attribute__((nonnull));
 static bool current_display_is_uptodate(size_t index)
     __attribute__((pure));
 static void check_cand_overwritten(void);
@@ -351,6 +356,12 @@ static void go_to_index(size_t index);
 static void go_to_after_editline(void);
 static void fillip_cursor(void);
 
+static const wchar_t *displayed_value(const le_candidate_T *cand)
+    __attribute__((nonnull,pure));
+static int printable_width(const wchar_t *s)
+    __attribute__((nonnull,pure));
+static void make_raw(le_candidate_T *cand)
+    __attribute__((nonnull));
 static void print_candidate_rawvalue(const le_candidate_T *cand)
     __attribute__((nonnull));
 static void update_candidates(void);
@@ -363,7 +374,7 @@ static void free_candcol(void *candcol)
     __attribute__((nonnull));
 static void print_candidates_all(void);
 static void update_highlighted_candidate(void);
-static void print_candidate(const le_candidate_T *cand, const candcol_T *col,
+static void print_candidate(le_candidate_T *cand, const candcol_T *col,
         bool highlight, bool printdesc)
     __attribute__((nonnull));
 static void print_candidate_count(size_t pageindex);
@@ -517,12 +528,25 @@ void finish(void)
 }
 
 /* Flushes the contents of the print buffer to the standard error and destroys
- * the buffer. */
+ * the buffer.
+ * The contents are written with as few `write' calls as possible so that a
+ * screen update reaches the terminal in one piece. */
 void le_display_flush(void)
 {
     current_position = lebuf.pos;
-    fwrite(lebuf.buf.contents, 1, lebuf.buf.length, stderr);
+
     fflush(stderr);
+    const char *s = lebuf.buf.contents;
+    size_t n = lebuf.buf.length;
+    while (n > 0) {
+        ssize_t w = write(STDERR_FILENO, s, n);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        s += w, n -= w;
+    }
     sb_destroy(&lebuf.buf);
 }
 
@@ -682,6 +706,8 @@ void update_editline(void)
             return;
 
         go_to_index(index);
+        if (shift_editline(index))
+            return;
         if (current_editline[index] != L'\0')
             clear_editline();
     } else {
@@ -735,6 +761,101 @@ void update_editline(void)
     check_cand_overwritten();
 }
 
+/* Updates the edit line on the screen by inserting or deleting characters at
+ * `index' with the "ich" or "dch" capability so that the unchanged characters
+ * after the insertion or deletion are not reprinted.
+ * This is done only if both the current and new edit lines fit in the screen
+ * line of `editbasepos', there is no prediction, and the right prompt is not on
+ * that line.
+ * The cursor must be at `index' in the current edit line, which is the first
+ * index where the current and new edit lines differ.
+ * Returns true iff the edit line has been updated. Otherwise, nothing is
+ * printed. */
+bool shift_editline(size_t index)
+{
+    size_t oldlength = wcslen(current_editline);
+    size_t newlength = le_main_buffer.length;
+    if (current_length < oldlength || le_main_length < newlength)
+        return false;  /* there is a prediction */
+    if (index == oldlength || index == newlength)
+        return false;  /* appending or truncating needs no shift */
+    if (rprompt_line == editbasepos.line)
+        return false;
+
+    int linebase = editbasepos.line * lebuf.maxcolumn;
+    if (cursor_positions[oldlength] - linebase >= lebuf.maxcolumn)
+        return false;
+
+    const wchar_t *newline = le_main_buffer.contents;
+    size_t count;
+    int width;
+    if (oldlength < newlength) {
+        /* check if characters are inserted at `index' */
+        count = newlength - oldlength;
+        if (wcscmp(&current_editline[index], &newline[index + count]) != 0)
+            return false;
+        width = editline_width(&newline[index], count);
+        if (cursor_positions[oldlength] - linebase + width >= lebuf.maxcolumn)
+            return false;
+        if (width > 0 && !lebuf_print_ich(width))
+            return false;
+
+        update_styler();
+        current_editline = xreallocn(current_editline,
+                newlength + 1, sizeof *current_editline);
+        cursor_positions = xreallocn(cursor_positions,
+                newlength + 1, sizeof *cursor_positions);
+        wmemmove(&current_editline[index + count], &current_editline[index],
+                oldlength - index + 1);
+        memmove(&cursor_positions[index + count], &cursor_positions[index],
+                (oldlength - index + 1) * sizeof *cursor_positions);
+        for (size_t i = index; i < index + count; i++) {
+            current_editline[i] = newline[i];
+            cursor_positions[i] = linebase + lebuf.pos.column;
+            lebuf_putwchar(newline[i], true);
+        }
+        for (size_t i = index + count; i <= newlength; i++)
+            cursor_positions[i] += width;
+        lebuf_print_sgr0(), styler_active = false;
+    } else if (oldlength > newlength) {
+        /* check if characters are deleted at `index' */
+        count = oldlength - newlength;
+        if (wcscmp(&current_editline[index + count], &newline[index]) != 0)
+            return false;
+        width = cursor_positions[index + count] - cursor_positions[index];
+        if (width > 0 && !lebuf_print_dch(width))
+            return false;
+
+        wmemmove(&current_editline[index], &current_editline[index + count],
+                newlength - index + 1);
+        memmove(&cursor_positions[index], &cursor_positions[index + count],
+                (newlength - index + 1) * sizeof *cursor_positions);
+        for (size_t i = index; i <= newlength; i++)
+            cursor_positions[i] -= width;
+    } else {
+        return false;
+    }
+
+    current_length = le_main_length;
+    return true;
+}
+
+/* Returns the width of the first `n' characters of `s' printed in the edit
+ * line. */
+int editline_width(const wchar_t *s, size_t n)
+{
+    struct lebuf_T save = lebuf;
+
+    lebuf_init_with_max((le_pos_T) { 0, 0 }, -1);
+    for (size_t i = 0; i < n; i++)
+        lebuf_putwchar(s[i], true);
+    int width = lebuf.pos.column;
+    sb_destroy(&lebuf.buf);
+
+    lebuf = save;
+    return width;
+}
+
 bool current_display_is_uptodate(size_t index)
 {
     if (current_editline[index] != le_main_buffer.contents[index])
@@ -924,8 +1045,11 @@ void fillip_cursor(void)
 }
 
 
-/* Sets the `raw' and `width' members of candidates in `le_candidates'.
- * This function uses the print buffer to calculate the widths. */
+/* Sets the `width' members of the raw values of candidates in
+ * `le_candidates'.
+ * The widths are needed to arrange all the candidates into pages, but the `raw'
+ * members are set by `make_raw' only when the candidate is actually printed
+ * so that a huge candidate list costs only the visible part of it. */
 void le_display_make_rawvalues(void)
 {
     assert(le_candidates.contents != NULL);
@@ -934,46 +1058,80 @@ void le_display_make_rawvalues(void)
         le_candidate_T *cand = le_candidates.contents[i];
 
         assert(cand->rawvalue.raw == NULL);
-        lebuf_init_with_max((le_pos_T) { 0, 0 }, -1);
-
-        print_candidate_rawvalue(cand);
-
-        cand->rawvalue.raw = sb_tostr(&lebuf.buf);
-        cand->rawvalue.width = lebuf.pos.column;
+        cand->rawvalue.width = printable_width(displayed_value(cand));
+        if (cand->type == CT_OPTION && cand->value[0] != L'-')
+            cand->rawvalue.width++;
 
         assert(cand->rawdesc.raw == NULL);
-        if (cand->desc != NULL) {
-            lebuf_init_with_max((le_pos_T) { 0, 0 }, -1);
-
-            lebuf_putws_trunc(cand->desc);
-
-            cand->rawdesc.raw = sb_tostr(&lebuf.buf);
-            cand->rawdesc.width = lebuf.pos.column;
-        }
+        if (cand->desc != NULL)
+            cand->rawdesc.width = printable_width(cand->desc);
     }
 }
 
-/* Prints the "raw value" of the specified candidate to the print buffer.
- * The output is truncated when the cursor reaches the end of the line. */
-void print_candidate_rawvalue(const le_candidate_T *cand)
+/* Returns the part of the candidate's value that is shown in the candidate
+ * area. For a file candidate, directory components are skipped. */
+const wchar_t *displayed_value(const le_candidate_T *cand)
 {
     const wchar_t *s = cand->value;
 
     if (cand->type == CT_FILE) {
-        /* skip directory components for a file candidate */
         for (;;) {
             const wchar_t *ss = wcschr(s, L'/');
             if (ss == NULL || *++ss == L'\0')
                 break;
             s = ss;
         }
-    } else if (cand->type == CT_OPTION) {
-        /* prepend a hyphen if none */
-        if (cand->value[0] != L'-')
-            lebuf_putwchar_trunc(L'-');
     }
+    return s;
+}
 
-    lebuf_putws_trunc(s);
+/* Returns the width of the specified string printed by `lebuf_putws_trunc'
+ * without truncation. */
+int printable_width(const wchar_t *s)
+{
+    int width = 0;
+    for (; *s != L'\0'; s++) {
+        int w = wcwidth(*s);
+        if (w > 0)
+            width += w;
+    }
+    return width;
+}
+
+/* Sets the `raw' members of the specified candidate if not yet set.
+ * This function uses the print buffer, so the current contents of the print
+ * buffer are saved and restored. */
+void make_raw(le_candidate_T *cand)
+{
+    if (cand->rawvalue.raw != NULL)
+        return;
+
+    struct lebuf_T save = lebuf;
+
+    lebuf_init_with_max((le_pos_T) { 0, 0 }, -1);
+    print_candidate_rawvalue(cand);
+    cand->rawvalue.raw = sb_tostr(&lebuf.buf);
+    assert(cand->rawvalue.width == lebuf.pos.column);
+
+    if (cand->desc != NULL) {
+        lebuf_init_with_max((le_pos_T) { 0, 0 }, -1);
+        lebuf_putws_trunc(cand->desc);
+        cand->rawdesc.raw = sb_tostr(&lebuf.buf);
+        assert(cand->rawdesc.width == lebuf.pos.column);
+    }
+
+    lebuf = save;
+}
+
+/* Prints the "raw value" of the specified candidate to the print buffer.
+ * The output is truncated when the cursor reaches the end of the line. */
+void print_candidate_rawvalue(const le_candidate_T *cand)
+{
+    /* prepend a hyphen if none */
+    if (cand->type == CT_OPTION && cand->value[0] != L'-')
+        lebuf_putwchar_trunc(L'-');
+
+    lebuf_putws_trunc(displayed_value(cand));
 }
 
 /* Updates the candidate area.
@@ -1028,7 +1186,13 @@ void make_pages_and_columns(void)
 #endif
 
     /* first check if the candidates fit into one page */
-    for (size_t cand_per_col = 1; cand_per_col <= maxrow; cand_per_col++) {
+    /* Each column is at least two characters wide, so columns with fewer
+     * candidates than `min_cand_per_col' never fit into the screen. */
+    size_t maxcolcount = (size_t) (le_columns - 1) / 2;
+    size_t min_cand_per_col = (le_candidates.length - 1) / maxcolcount + 1;
+    for (size_t cand_per_col = min_cand_per_col;
+            cand_per_col <= maxrow;
+            cand_per_col++) {
         if (arrange_candidates(cand_per_col, le_columns)) {
             candpage_T *page = xmalloc(sizeof *page);
             page->colindex = 0;
@@ -1315,11 +1479,13 @@ void update_highlighted_candidate(void)
  * The candidate is highlighted iff `highlight' is true.
  * Iff `printdesc' is true, the candidate's description is printed.
  * The cursor is left just after the printed candidate. */
-void print_candidate(const le_candidate_T *cand, const candcol_T *col,
+void print_candidate(le_candidate_T *cand, const candcol_T *col,
         bool highlight, bool printdesc)
 {
     int line = lebuf.pos.line;
 
+    make_raw(cand);
+
     /* print value */
     if (true /* cand->value != NULL */) {
         int base = lebuf.pos.column;
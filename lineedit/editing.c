@@ -94,6 +94,18 @@ xwcsbuf_T le_search_buffer;
 /* The search result for the current value of `le_search_buffer'.
  * If there is no match, `le_search_result' is `Histlist'. */
 const histlink_T *le_search_result;
+/* Results of the searches performed by `perform_search' for the prefixes of
+ * `pattern', which are reused when the pattern is extended or shortened during
+ * incremental search. `results.contents[i]' is the result for the first i+1
+ * characters of `pattern', or NULL if unknown. The results are valid only for
+ * searches of `type' in `direction' starting from `start'. */
+static struct {
+    wchar_t *pattern;
+    plist_T results;
+    const histlink_T *start;
+    enum le_search_direction_T direction;
+    enum le_search_type_T type;
+} search_cache = { .pattern = NULL, };
 /* The search string and the direction of the last search. */
 static struct {
     enum le_search_direction_T direction;
@@ -202,8 +214,12 @@ static bool reset_completion;
 /* The next value of `reset_completion'. */
 static bool next_reset_completion;
 
-/* Probability distribution tree for command prediction. */
+/* Probability distribution tree for command prediction.
+ * The tree is created when a prediction is first needed in a line-editing
+ * session. If `prediction_initial' is not L'\0', the tree contains only the
+ * history entries that start with that character. */
 static trie_T *prediction_tree = NULL;
+static wchar_t prediction_initial;
 
 
 static void reset_state(void);
@@ -296,7 +312,8 @@ static void cancel_undo(int offset);
 
 static void check_reset_completion(void);
 
-static void create_prediction_tree(void);
+static trie_T *create_prediction_tree(wchar_t initial)
+    __attribute__((malloc,warn_unused_result));
 static size_t count_matching_previous_commands(const histentry_T *e1)
     __attribute__((nonnull,pure));
 static void clear_prediction(void);
@@ -327,6 +344,14 @@ static void update_search(void);
 static void perform_search(const wchar_t *pattern,
         enum le_search_direction_T dir, enum le_search_type_T type)
     __attribute__((nonnull));
+static size_t find_cached_search(const wchar_t *pattern,
+        const histlink_T *start,
+        enum le_search_direction_T dir, enum le_search_type_T type)
+    __attribute__((nonnull));
+static void add_cached_search(
+        const wchar_t *pattern, size_t patternlen, const histlink_T *result)
+    __attribute__((nonnull));
+static void clear_search_cache(void);
 static void search_again(enum le_search_direction_T dir);
 static void beginning_search(enum le_search_direction_T dir);
 static inline bool beginning_search_check_go_to_history(const wchar_t *prefix)
@@ -367,10 +392,8 @@ void le_editing_init(void)
     reset_state();
     set_overwriting(false);
 
-    if (shopt_le_predict) {
-        create_prediction_tree();
+    if (shopt_le_predict)
         update_buffer_with_prediction();
-    }
 }
 
 /* Finalizes the editing module when editing is finished.
@@ -382,12 +405,14 @@ wchar_t *le_editing_finalize(void)
     plfree(pl_toary(&undo_history), free);
 
     le_complete_cleanup();
+    le_complete_clear_cache();
 
     end_using_history();
     free(main_history_value);
 
     clear_prediction();
     trie_destroy(prediction_tree), prediction_tree = NULL;
+    clear_search_cache();
     wb_wccat(&le_main_buffer, L'\n');
     return wb_towcs(&le_main_buffer);
 }
@@ -2509,10 +2534,24 @@ void check_reset_completion(void)
 #define MAX_PREDICTION_SAMPLE 10000
 #endif /* ifndef MAX_PREDICTION_SAMPLE */
 
-/* Create a probability distribution tree for command prediction based on the
- * current history. The result is set to `prediction_tree'. */
-void create_prediction_tree(void)
+/* Creates a probability distribution tree for command prediction based on the
+ * current history.
+ * If `initial' is not L'\0', only the history entries starting with `initial'
+ * are added to the tree, which is enough to predict the rest of a line starting
+ * with `initial'. The other entries still count in the probabilities, so the
+ * prediction is the same as that from the tree of all the entries. */
+trie_T *create_prediction_tree(wchar_t initial)
 {
+    char mbsinitial[MB_LEN_MAX];
+    size_t mbsinitiallen = 0;
+    if (initial != L'\0') {
+        mbstate_t state;
+        memset(&state, 0, sizeof state);
+        mbsinitiallen = wcrtomb(mbsinitial, initial, &state);
+        if (mbsinitiallen == (size_t) -1)
+            mbsinitiallen = 0;
+    }
+
     trie_T *t = trie_create();
 #define N 4
     size_t hits[N] = {0};
@@ -2524,6 +2563,8 @@ void create_prediction_tree(void)
             hits[i]++;
         if (hits[0] >= MAX_PREDICTION_SAMPLE)
             break;
+        if (strncmp(e->value, mbsinitial, mbsinitiallen) != 0)
+            continue;
 
         wchar_t *cmd = malloc_mbstowcs(e->value);
         if (cmd == NULL)
@@ -2532,7 +2573,7 @@ void create_prediction_tree(void)
         free(cmd);
     }
 
-    prediction_tree = t;
+    return t;
 }
 
 // Counts N-1 at most
@@ -2581,6 +2622,15 @@ void update_buffer_with_prediction(void)
 
     le_main_length = le_main_buffer.length;
 
+    /* (re)create the tree if it does not contain the entries to predict */
+    wchar_t initial = le_main_buffer.contents[0];
+    if (prediction_tree == NULL ||
+            (prediction_initial != L'\0' && prediction_initial != initial)) {
+        trie_destroy(prediction_tree);
+        prediction_tree = create_prediction_tree(initial);
+        prediction_initial = initial;
+    }
+
     wchar_t *suffix = trie_probable_key(
             prediction_tree, le_main_buffer.contents);
     wb_catfree(&le_main_buffer, suffix);
@@ -3731,6 +3781,28 @@ void perform_search(const wchar_t *pattern,
     if (dir == FORWARD && l == Histlist)
         goto done;
 
+    /* In prefix and emacs searches, the pattern is a literal string. An entry
+     * that does not contain (or start with) a prefix of the pattern cannot
+     * contain (or start with) the pattern, so the search can be resumed from
+     * the result for the longest prefix that has been searched for. */
+    size_t patternlen = 0;
+    if (type != SEARCH_VI) {
+        patternlen = wcslen(pattern);
+        size_t k = find_cached_search(pattern, l, dir, type);
+        if (k > 0) {
+            const histlink_T *r = search_cache.results.contents[k - 1];
+            if (k == patternlen || r == Histlist) {
+                l = r;
+                goto cache;
+            }
+            /* resume the search including `r' itself */
+            switch (dir) {
+                case FORWARD:   l = r->prev;  break;
+                case BACKWARD:  l = r->next;  break;
+            }
+        }
+    }
+
     switch (type) {
         case SEARCH_PREFIX: {
             wchar_t *p = escape(pattern, NULL);
@@ -3776,10 +3848,73 @@ void perform_search(const wchar_t *pattern,
             break;
     }
     xfnm_free(xfnm);
+cache:
+    if (patternlen > 0)
+        add_cached_search(pattern, patternlen, l);
 done:
     le_search_result = l;
 }
 
+/* Returns the length of the longest prefix of `pattern' for which the search
+ * result is known in `search_cache'. If the cache is not valid for a search
+ * starting from `start' in `dir' of `type', the cache is reset and zero is
+ * returned. */
+size_t find_cached_search(const wchar_t *pattern, const histlink_T *start,
+        enum le_search_direction_T dir, enum le_search_type_T type)
+{
+    if (search_cache.pattern == NULL || search_cache.start != start ||
+            search_cache.direction != dir || search_cache.type != type) {
+        clear_search_cache();
+        search_cache.pattern = xwcsdup(L"");
+        pl_init(&search_cache.results);
+        search_cache.start = start;
+        search_cache.direction = dir;
+        search_cache.type = type;
+        return 0;
+    }
+
+    size_t k = 0;
+    while (k < search_cache.results.length &&
+            pattern[k] != L'\0' && pattern[k] == search_cache.pattern[k])
+        k++;
+    while (k > 0 && search_cache.results.contents[k - 1] == NULL)
+        k--;
+    return k;
+}
+
+/* Records `result' in `search_cache' as the search result for `pattern'.
+ * `find_cached_search' must have been called for the same search. */
+void add_cached_search(
+        const wchar_t *pattern, size_t patternlen, const histlink_T *result)
+{
+    assert(search_cache.pattern != NULL);
+    assert(patternlen > 0);
+
+    if (wcsncmp(pattern, search_cache.pattern, patternlen) != 0 ||
+            search_cache.results.length < patternlen) {
+        size_t k = 0;
+        while (k < search_cache.results.length &&
+                pattern[k] == search_cache.pattern[k])
+            k++;
+        pl_truncate(&search_cache.results, k);
+        while (search_cache.results.length < patternlen)
+            pl_add(&search_cache.results, NULL);
+        free(search_cache.pattern);
+        search_cache.pattern = xwcsdup(pattern);
+    }
+    search_cache.results.contents[patternlen - 1] = (void *) result;
+}
+
+/* Discards the results in `search_cache'. */
+void clear_search_cache(void)
+{
+    if (search_cache.pattern != NULL) {
+        free(search_cache.pattern);
+        search_cache.pattern = NULL;
+        pl_destroy(&search_cache.results);
+    }
+}
+
 /* Redoes the last search. */
 void cmd_search_again(wchar_t c __attribute__((unused)))
 {
@@ -74,10 +74,14 @@
 #define TI_cuf1    "cuf1"
 #define TI_cuu     "cuu"
 #define TI_cuu1    "cuu1"
+#define TI_dch     "dch"
+#define TI_dch1    "dch1"
 #define TI_dim     "dim"
 #define TI_ed      "ed"
 #define TI_el      "el"
 #define TI_flash   "flash"
+#define TI_ich     "ich"
+#define TI_ich1    "ich1"
 #define TI_invis   "invis"
 #define TI_kBEG    "kBEG"
 #define TI_kCAN    "kCAN"
@@ -285,6 +289,8 @@ static _Bool move_cursor_1(char *capone, long count)
     __attribute__((nonnull));
 static _Bool move_cursor_mul(char *capmul, long count, int affcnt)
     __attribute__((nonnull));
+static _Bool print_count_cap(char *capone, char *capmul, long count)
+    __attribute__((nonnull));
 static void print_color_code(long color, char *seta, char *set)
     __attribute__((nonnull));
 static void print_smkx(void);
@@ -690,6 +696,36 @@ _Bool lebuf_print_ed(void)
     return try_print_cap(TI_ed);
 }
 
+/* Prints the "ich"/"ich1" code to the print buffer if available.
+ * (insert `count' blank characters at the cursor, shifting the rest of the
+ * line to the right)
+ * The cursor position is not changed.
+ * Returns true iff successful. */
+_Bool lebuf_print_ich(long count)
+{
+    return print_count_cap(TI_ich1, TI_ich, count);
+}
+
+/* Prints the "dch"/"dch1" code to the print buffer if available.
+ * (delete `count' characters at the cursor, shifting the rest of the line to
+ * the left)
+ * The cursor position is not changed.
+ * Returns true iff successful. */
+_Bool lebuf_print_dch(long count)
+{
+    return print_count_cap(TI_dch1, TI_dch, count);
+}
+
+/* Like `move_cursor', but returns false without printing anything if neither
+ * capability is available. */
+_Bool print_count_cap(char *capone, char *capmul, long count)
+{
+    assert(count > 0);
+    if (count == 1 && move_cursor_1(capone, 1))
+        return 1;
+    return move_cursor_mul(capmul, count, 1) || move_cursor_1(capone, count);
+}
+
 /* Prints the "clear" code if available. (clear whole screen)
  * Returns true iff successful. */
 _Bool lebuf_print_clear(void)
@@ -49,6 +49,8 @@ extern void lebuf_print_cud(long count);
 extern void lebuf_print_cuu(long count);
 extern _Bool lebuf_print_el(void);
 extern _Bool lebuf_print_ed(void);
+extern _Bool lebuf_print_ich(long count);
+extern _Bool lebuf_print_dch(long count);
 extern _Bool lebuf_print_clear(void);
 extern _Bool lebuf_print_op(void);
 extern void lebuf_print_setfg(long color);
@@ -259,7 +259,7 @@ bool is_update(const char *path)
     }
 
     bool result;
-    mailfile_T *mf = ht_get(&mailfiles, path).value;
+    mailfile_T *mf = ht_getstr(&mailfiles, path).value;
 
     if (mf != NULL) {
         result = (st.st_size > 0 || posixly_correct) &&
@@ -96,6 +96,7 @@ void comsfree(command_T *c)
             case CT_SIMPLE:
                 assignsfree(c->c_assigns);
                 plfree(c->c_words, wordfree_vp);
+                free(c->c_cmdcache);
                 break;
             case CT_GROUP:
             case CT_SUBSHELL:
@@ -262,6 +263,10 @@ void redirsfree(redir_T *r)
             case RT_HERE:  case RT_HERERT:
                 free(r->rd_hereend);
                 wordfree(r->rd_herecontent);
+                if (r->rd_herecache != NULL) {
+                    free(r->rd_herecache->contents);
+                    free(r->rd_herecache);
+                }
                 break;
             case RT_PROCIN:  case RT_PROCOUT:
                 embedcmdfree(r->rd_command);
@@ -1310,7 +1315,7 @@ wordunit_T *tryparse_paramexp_raw(parsestate_T *ps)
 success:;
     paramexp_T *pe = xmalloc(sizeof *pe);
     pe->pe_type = PT_NONE;
-    pe->pe_name = xwcsndup(&ps->src.contents[ps->index], namelen);
+    set_paramexp_name(pe, xwcsndup(&ps->src.contents[ps->index], namelen));
     pe->pe_start = pe->pe_end = pe->pe_match = pe->pe_subst = NULL;
 
     wordunit_T *result = xmalloc(sizeof *result);
@@ -1396,7 +1401,8 @@ parse_name:;
             serror(ps, Ngt("the parameter name is missing or invalid"));
             goto end;
         }
-        pe->pe_name = xwcsndup(&ps->src.contents[namestartindex], namelen);
+        set_paramexp_name(pe,
+                xwcsndup(&ps->src.contents[namestartindex], namelen));
     }
 
     /* parse indices */
@@ -2056,6 +2062,7 @@ command_T *parse_command(parsestate_T *ps)
     result->c_lineno = ps->info->lineno;
     result->c_type = CT_SIMPLE;
     result->c_assigns = NULL;
+    result->c_cmdcache = NULL;
     result->c_redirs = NULL;
     result->c_words = parse_simple_command_tokens(
             ps, &result->c_assigns, &result->c_redirs);
@@ -2180,6 +2187,7 @@ assign_T *tryparse_assignment(parsestate_T *ps)
     assign_T *result = xmalloc(sizeof *result);
     result->next = NULL;
     result->a_name = xwcsndup(ps->token->wu_string, namelen);
+    result->a_namehash = hashwcs(result->a_name);
 
     /* remove the name and '=' from the token */
     size_t index_after_first_token = ps->next_index;
@@ -2311,6 +2319,7 @@ parse_here_document_tag:
     result->rd_hereend =
         xwcsndup(&ps->src.contents[ps->index], ps->next_index - ps->index);
     result->rd_herecontent = NULL;
+    result->rd_herecache = NULL;
     if (ps->token == NULL) {
         serror(ps, Ngt("the end-of-here-document indicator is missing"));
     } else {
@@ -2518,6 +2527,7 @@ command_T *parse_for(parsestate_T *ps)
 
     result->c_forname =
         xwcsndup(&ps->src.contents[ps->index], ps->next_index - ps->index);
+    result->c_fornamehash = hashwcs(result->c_forname);
     if (!is_name_word(ps->token)) {
         if (ps->token == NULL)
             serror(ps, Ngt("an identifier is required after `for'"));
@@ -3160,6 +3170,13 @@ void read_heredoc_contents(parsestate_T *ps, redir_T *r)
         read_heredoc_contents_without_expansion(ps, r);
     else
         read_heredoc_contents_with_expansion(ps, r);
+
+    /* prepare the cache if the contents does not depend on expansions */
+    for (const wordunit_T *wu = r->rd_herecontent; wu != NULL; wu = wu->next)
+        if (wu->wu_type != WT_STRING)
+            return;
+    r->rd_herecache = xmalloc(sizeof *r->rd_herecache);
+    r->rd_herecache->contents = NULL;
 }
 
 /* Reads the contents of a here-document without any parameter expansions. */
@@ -24,6 +24,7 @@
 #define YASH_PARSER_H
 
 #include <stddef.h>
+#include "hashtable.h"
 #include "input.h"
 #include "refcount.h"
 
@@ -79,11 +80,13 @@ typedef struct command_T {
         struct {
             struct assign_T *assigns;  /* assignments */
             void           **words;    /* command name and arguments */
+            struct cmdcache_T *cmdcache; /* last result of command search */
         } simplecommand;
         struct and_or_T     *subcmds;  /* contents of command group */
         struct ifcommand_T  *ifcmds;   /* contents of if command */
         struct {
             wchar_t         *forname;  /* loop variable of for loop */
+            hashval_T        fornamehash; /* hash value of `forname' */
             void           **forwords; /* words assigned to loop variable */
             struct and_or_T *forcmds;  /* commands executed in for loop */
         } forloop;
@@ -105,9 +108,11 @@ typedef struct command_T {
 } command_T;
 #define c_assigns  c_content.simplecommand.assigns
 #define c_words    c_content.simplecommand.words
+#define c_cmdcache c_content.simplecommand.cmdcache
 #define c_subcmds  c_content.subcmds
 #define c_ifcmds   c_content.ifcmds
 #define c_forname  c_content.forloop.forname
+#define c_fornamehash c_content.forloop.fornamehash
 #define c_forwords c_content.forloop.forwords
 #define c_forcmds  c_content.forloop.forcmds
 #define c_whltype  c_content.whileloop.whltype
@@ -246,6 +251,7 @@ typedef struct paramexp_T {
         wchar_t           *name;
         struct wordunit_T *nest;
     } pe_value;
+    hashval_T pe_namehash;
     struct wordunit_T *pe_start, *pe_end;
     struct wordunit_T *pe_match, *pe_subst;
 } paramexp_T;
@@ -253,6 +259,7 @@ typedef struct paramexp_T {
 #define pe_nest pe_value.nest
 /* pe_name:  name of parameter
  * pe_nest:  nested parameter expansion
+ * pe_namehash: hash value of `pe_name' computed by `hashwcs'
  * pe_start: index of the first element in the range
  * pe_end:   index of the last element in the range
  * pe_match: word to be matched with the value of the parameter
@@ -260,6 +267,18 @@ typedef struct paramexp_T {
  * `pe_start' and `pe_end' is NULL if the indices are not specified.
  * `pe_match' and `pe_subst' may be NULL to denote an empty string. */
 
+static inline void set_paramexp_name(paramexp_T *pe, wchar_t *name)
+    __attribute__((nonnull));
+
+/* Sets `pe_name' of the parameter expansion together with `pe_namehash'.
+ * Every parameter expansion that has a name must be given it by this function
+ * so that the hash value is always valid. */
+void set_paramexp_name(paramexp_T *pe, wchar_t *name)
+{
+    pe->pe_name = name;
+    pe->pe_namehash = hashwcs(name);
+}
+
 /* type of assignment */
 typedef enum {
     A_SCALAR, A_ARRAY,
@@ -270,6 +289,7 @@ typedef struct assign_T {
     struct assign_T *next;
     assigntype_T a_type;
     wchar_t *a_name;
+    hashval_T a_namehash;  /* hash value of `a_name' */
     union {
         struct wordunit_T *scalar;
         void **array;          
@@ -307,6 +327,7 @@ typedef struct redir_T {
         struct {
             wchar_t *hereend;  /* token indicating end of here-document */
             struct wordunit_T *herecontent;  /* contents of here-document */
+            struct herecache_T *herecache;   /* converted constant contents */
         } heredoc;
         struct embedcmd_T command;
     } rd_value;
@@ -314,6 +335,7 @@ typedef struct redir_T {
 #define rd_filename    rd_value.filename
 #define rd_hereend     rd_value.heredoc.hereend
 #define rd_herecontent rd_value.heredoc.herecontent
+#define rd_herecache   rd_value.heredoc.herecache
 #define rd_command     rd_value.command
 /* For example, for "2>&1", `rd_type' = RT_DUPOUT, `rd_fd' = 2 and
  * `rd_filename' = "1".
@@ -321,7 +343,17 @@ typedef struct redir_T {
  * already removed. If `rd_hereend' is quoted, `rd_herecontent' is a single
  * word unit of type WT_STRING, since no parameter expansions are performed.
  * Anyway `rd_herecontent' is expanded by calling `expand_string' with `esc'
- * argument being true. */
+ * argument being true.
+ * If `rd_herecontent' contains no expansions, `rd_herecache' is a non-null
+ * pointer to a `herecache_T' in which the redirection code caches the result
+ * of the expansion. Otherwise, `rd_herecache' is null. */
+
+/* Cached contents of a here-document that contains no expansions */
+typedef struct herecache_T {
+    char *contents;          /* multibyte contents or null if not cached */
+    size_t length;           /* number of bytes in `contents' */
+    unsigned long ctypegen;  /* `ctype_generation' at the conversion */
+} herecache_T;
 
 
 /********** Interface to Parsing Routines **********/
@@ -357,6 +357,21 @@ static inline void forget_command_path(const char *command)
     __attribute__((nonnull));
 static wchar_t *get_default_path(void)
     __attribute__((malloc,warn_unused_result));
+static void clear_cmddirhash(void);
+static void free_cmddir(kvpair_T kv);
+static unsigned long get_mtimensec(const struct stat *st)
+    __attribute__((nonnull,pure));
+struct cmddir_T;
+static struct cmddir_T *get_cmddir(
+        hashtable_T *table, const char *dirpath, bool executables_only)
+    __attribute__((nonnull));
+static size_t search_cmddir(const struct cmddir_T *cd, const char *name)
+    __attribute__((nonnull,pure));
+static bool scan_command_directory(
+        const char *dirpath, plist_T *names, bool executables_only)
+    __attribute__((nonnull));
+static int sort_names_cmp(const void *v1, const void *v2)
+    __attribute__((nonnull,pure));
 
 /* A hashtable from command names to their full path.
  * Keys are pointers to a multibyte string containing a command name and
@@ -375,10 +390,12 @@ void init_cmdhash(void)
     ht_init(&cmdhash, hashstr, htstrcmp);
 }
 
-/* Empties the command hashtable. */
+/* Empties the command hashtable.
+ * The command directory index is also emptied. */
 void clear_cmdhash(void)
 {
     ht_clear(&cmdhash, vfree);
+    clear_cmddirhash();
 }
 
 /* Searches PATH for the specified command and returns its full pathname.
@@ -391,7 +408,7 @@ const char *get_command_path(const char *name, bool forcelookup)
     const char *path;
 
     if (!forcelookup) {
-        path = ht_get(&cmdhash, name).value;
+        path = ht_getstr(&cmdhash, name).value;
         if (path != NULL && path[0] == '/' && is_executable_regular(path))
             return path;
     }
@@ -408,6 +425,18 @@ const char *get_command_path(const char *name, bool forcelookup)
     return path;
 }
 
+/* Same as `get_command_path(name, false)', but the result is not remembered
+ * in the command hashtable. Used where the search would otherwise have been
+ * done in a child process, which must not affect the shell's hashtable.
+ * The result is a newly-malloced string or NULL. */
+char *get_command_path_uncached(const char *name)
+{
+    const char *path = ht_getstr(&cmdhash, name).value;
+    if (path != NULL && path[0] == '/' && is_executable_regular(path))
+        return xstrdup(path);
+    return which(name, get_path_array(PA_PATH), is_executable_regular);
+}
+
 /* Removes the specified command from the command hashtable. */
 void forget_command_path(const char *command)
 {
@@ -466,6 +495,264 @@ wchar_t *get_default_path(void)
 }
 
 
+/* The type of objects that remember the names of files in a directory for
+ * `get_directory_commands' and `which_indexed'. */
+typedef struct cmddir_T {
+    dev_t cd_dev;
+    ino_t cd_ino;
+    time_t cd_mtime;
+    unsigned long cd_mtimensec;
+    bool cd_racy;      // if the directory may be modified after scanning
+    bool cd_complete;  // if all the entries could be read
+    unsigned cd_epoch; // value of `cmddir_epoch' when last validated
+    plist_T cd_names;  // sorted names of the files
+    char cd_path[];
+} cmddir_T;
+
+/* A hashtable from directory pathnames to `cmddir_T' objects that contain the
+ * names of executable regular files.
+ * Keys are the `cd_path' members of the values. */
+static hashtable_T cmddirhash;
+/* Like `cmddirhash', but the `cmddir_T' objects contain the names of all
+ * files. Used by `which_indexed'. */
+static hashtable_T loaddirhash;
+
+/* While `cmddir_frozen' is true, directories that have been validated in the
+ * current epoch are assumed unmodified and not `stat'ed again.
+ * The epoch number is incremented each time the index is frozen so that no
+ * validation in an earlier period is mistaken for one in the current period.
+ * See `freeze_directory_index'. */
+static bool cmddir_frozen = false;
+static unsigned cmddir_epoch = 0;
+
+/* Empties the command directory index. */
+void clear_cmddirhash(void)
+{
+    if (cmddirhash.capacity > 0)
+        ht_clear(&cmddirhash, free_cmddir);
+    if (loaddirhash.capacity > 0)
+        ht_clear(&loaddirhash, free_cmddir);
+}
+
+/* Frees the `cmddir_T' object in the specified key-value pair. */
+void free_cmddir(kvpair_T kv)
+{
+    cmddir_T *cd = kv.value;
+    plfree(pl_toary(&cd->cd_names), free);
+    free(cd);
+}
+
+/* Returns the nanosecond part of the modification time in the stat result. */
+unsigned long get_mtimensec(const struct stat *st)
+{
+#if HAVE_ST_MTIM
+    return (unsigned long) st->st_mtim.tv_nsec;
+#elif HAVE_ST_MTIMESPEC
+    return (unsigned long) st->st_mtimespec.tv_nsec;
+#elif HAVE_ST_MTIMENSEC
+    return (unsigned long) st->st_mtimensec;
+#elif HAVE___ST_MTIMENSEC
+    return (unsigned long) st->__st_mtimensec;
+#else
+    (void) st;
+    return 0;
+#endif
+}
+
+/* Starts or ends a period during which the directories in the index are
+ * assumed unmodified.
+ * Normally, every lookup in the index `stat's the directory to check that the
+ * index is up to date. While the index is frozen, each directory is checked
+ * only for the first lookup. The line-editing module freezes the index during
+ * command line completion, which may look up the same directories many times.
+ */
+void freeze_directory_index(bool freeze)
+{
+    if (freeze) {
+        cmddir_epoch++;
+        if (cmddir_epoch == 0)
+            cmddir_epoch++;
+    }
+    cmddir_frozen = freeze;
+}
+
+/* Returns a NULL-terminated array of the names of the executable regular files
+ * in the specified directory, sorted in byte order.
+ * If `prefix' is non-NULL, the returned pointer points to the first name that
+ * is not less than `prefix' in the array, so all the names that start with
+ * `prefix' can be enumerated by iterating from the returned pointer while the
+ * names start with `prefix'.
+ * The directory is scanned once and the result is reused until the
+ * modification time of the directory changes or `clear_cmdhash' is called.
+ * Note that changes of the permissions of existing files are not noticed until
+ * the directory is modified.
+ * Returns NULL if the directory cannot be examined.
+ * The returned array is valid until the next call to this function or
+ * `clear_cmdhash'. */
+char *const *get_directory_commands(const char *dirpath, const char *prefix)
+{
+    const cmddir_T *cd = get_cmddir(&cmddirhash, dirpath, true);
+    if (cd == NULL)
+        return NULL;
+
+    char *const *names = (char *const *) cd->cd_names.contents;
+    if (prefix == NULL)
+        return names;
+    return &names[search_cmddir(cd, prefix)];
+}
+
+/* Searches directories `dirs' for a file named `name' that satisfies predicate
+ * `cond'.
+ * This function is equivalent to `which' except that the directories are
+ * looked up in the directory index before `cond' is called. If the index shows
+ * that a directory does not contain the file, `cond' is not called for it.
+ * This is effective when the file is usually missing in most directories. */
+char *which_indexed(
+        const char *restrict name,
+        char *const *restrict dirs,
+        bool cond(const char *path))
+{
+    if (name[0] == '\0' || name[0] == '/' || dirs == NULL)
+        return which(name, dirs, cond);
+
+    const char *slash = strrchr(name, '/');
+    const char *basename = (slash != NULL) ? &slash[1] : name;
+    if (basename[0] == '\0')
+        return which(name, dirs, cond);
+
+    xstrbuf_T path;
+    sb_init(&path);
+    for (const char *dir; (dir = *dirs) != NULL; dirs++) {
+        sb_truncate(&path, 0);
+        if (dir[0] != '\0') {
+            sb_cat(&path, dir);
+            if (path.contents[path.length - 1] != '/')
+                sb_ccat(&path, '/');
+        }
+        sb_ncat_force(&path, name, basename - name);
+
+        const cmddir_T *cd = get_cmddir(&loaddirhash,
+                (path.length == 0) ? "." : path.contents, false);
+        if (cd == NULL)
+            continue;
+        if (cd->cd_complete) {
+            size_t i = search_cmddir(cd, basename);
+            if (i >= cd->cd_names.length
+                    || strcmp(cd->cd_names.contents[i], basename) != 0)
+                continue;
+        }
+
+        sb_cat(&path, basename);
+        if (cond(path.contents))
+            return sb_tostr(&path);
+    }
+    sb_destroy(&path);
+    return NULL;
+}
+
+/* Returns the index entry for the specified directory, scanning the directory
+ * if the entry is missing or outdated.
+ * If `executables_only' is true, only executable regular files are included in
+ * the entry. `table' must be `cmddirhash' or `loaddirhash', respectively.
+ * Returns NULL if the directory cannot be examined. */
+cmddir_T *get_cmddir(
+        hashtable_T *table, const char *dirpath, bool executables_only)
+{
+    if (table->capacity == 0)
+        ht_init(table, hashstr, htstrcmp);
+
+    cmddir_T *cd = ht_getstr(table, dirpath).value;
+    if (cd != NULL && cmddir_frozen && cd->cd_epoch == cmddir_epoch)
+        return cd;
+
+    struct stat st;
+    if (stat(dirpath, &st) < 0 || !S_ISDIR(st.st_mode))
+        return NULL;
+
+    if (cd == NULL || cd->cd_racy
+            || cd->cd_dev != st.st_dev || cd->cd_ino != st.st_ino
+            || cd->cd_mtime != st.st_mtime
+            || cd->cd_mtimensec != get_mtimensec(&st)) {
+        if (cd == NULL) {
+            cd = xmallocs(sizeof *cd,
+                    add(strlen(dirpath), 1), sizeof *cd->cd_path);
+            strcpy(cd->cd_path, dirpath);
+            pl_init(&cd->cd_names);
+            ht_set(table, cd->cd_path, cd);
+        } else {
+            pl_clear(&cd->cd_names, free);
+        }
+
+        time_t now = time(NULL);
+        cd->cd_complete =
+            scan_command_directory(dirpath, &cd->cd_names, executables_only);
+        cd->cd_dev = st.st_dev;
+        cd->cd_ino = st.st_ino;
+        cd->cd_mtime = st.st_mtime;
+        cd->cd_mtimensec = get_mtimensec(&st);
+        /* If the directory was modified in the same second as it is scanned,
+         * another modification may follow without changing the modification
+         * time. Such a result must not be reused. */
+        cd->cd_racy = (now == (time_t) -1 || st.st_mtime >= now);
+    }
+    cd->cd_epoch = cmddir_epoch;
+    return cd;
+}
+
+/* Returns the index of the first name not less than `name' in the entry. */
+size_t search_cmddir(const cmddir_T *cd, const char *name)
+{
+    char *const *names = (char *const *) cd->cd_names.contents;
+    size_t lo = 0, hi = cd->cd_names.length;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(names[mid], name) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Adds the names of the files in the specified directory to `names' in sorted
+ * order. If `executables_only' is true, only executable regular files are
+ * added.
+ * Returns false if the directory could not be read. */
+bool scan_command_directory(
+        const char *dirpath, plist_T *names, bool executables_only)
+{
+    DIR *dir = opendir(dirpath);
+    if (dir == NULL)
+        return false;
+
+    xstrbuf_T path;
+    sb_init(&path);
+    sb_cat(&path, dirpath);
+    if (path.length > 0 && path.contents[path.length - 1] != '/')
+        sb_ccat(&path, '/');
+
+    size_t dirpathlen = path.length;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        sb_cat(&path, de->d_name);
+        if (!executables_only || is_executable_regular(path.contents))
+            pl_add(names, xstrdup(de->d_name));
+        sb_truncate(&path, dirpathlen);
+    }
+    sb_destroy(&path);
+    closedir(dir);
+
+    qsort(names->contents, names->length, sizeof *names->contents,
+            sort_names_cmp);
+    return true;
+}
+
+int sort_names_cmp(const void *v1, const void *v2)
+{
+    return strcmp(*(const char *const *) v1, *(const char *const *) v2);
+}
+
+
 /********** Home Directory Cache **********/
 
 static struct passwd *xgetpwnam(const char *name)
@@ -514,7 +801,7 @@ const wchar_t *get_home_directory(const wchar_t *username, bool forcelookup)
     const wchar_t *path;
 
     if (!forcelookup) {
-        path = ht_get(&homedirhash, username).value;
+        path = ht_getwcs(&homedirhash, username).value;
         if (path != NULL)
             return path;
     }
@@ -586,6 +873,13 @@ struct wglob_search {
  * same pathname. The multi-byte version is mainly used for calling OS APIs and
  * the wide version for producing the final results. */
 
+/* File type of a directory entry as far as it is known without `stat'ing it */
+enum wglob_filetype_T {
+    WGFT_UNKNOWN, WGFT_DIRECTORY, WGFT_OTHER,
+};
+/* WGFT_OTHER is used only for entries that are known to be neither a directory
+ * nor a symbolic link. */
+
 /* Data used in search for one level of directory */
 struct wglob_stack {
     const struct wglob_stack *prev;
@@ -633,7 +927,8 @@ static void wglob_search_literal_each(
         struct wglob_search *restrict s, const struct wglob_stack *restrict t)
     __attribute__((nonnull));
 static void wglob_add_result(
-        struct wglob_search *s, bool only_if_existing, bool markdir)
+        struct wglob_search *s, bool only_if_existing, bool markdir,
+        enum wglob_filetype_T type)
     __attribute__((nonnull));
 static void wglob_search_literal_uniq(
         struct wglob_search *restrict s, struct wglob_stack *restrict t)
@@ -641,15 +936,17 @@ static void wglob_search_literal_uniq(
 static bool wglob_scandir(
         struct wglob_search *restrict s, const struct wglob_stack *restrict t)
     __attribute__((nonnull));
+static inline enum wglob_filetype_T wglob_dirent_type(const struct dirent *de)
+    __attribute__((nonnull,pure));
 static void wglob_scandir_entry(
         const char *name, struct wglob_search *restrict s,
         const struct wglob_stack *restrict t, struct wglob_stack *restrict t2,
-        bool only_if_existing)
+        bool only_if_existing, enum wglob_filetype_T type)
     __attribute__((nonnull));
 static bool wglob_should_recurse(
         const char *restrict name, const char *restrict path,
         const struct wglob_pattern *restrict c, struct wglob_stack *restrict t,
-        size_t count)
+        size_t count, enum wglob_filetype_T type)
     __attribute__((nonnull));
 static bool wglob_is_reentry(const struct wglob_stack *const t, size_t count)
     __attribute__((nonnull,pure));
@@ -920,7 +1217,7 @@ void wglob_search_literal_each(
             free(t2);
         } else {
             /* This is the last component. */
-            wglob_add_result(s, true, false);
+            wglob_add_result(s, true, false, WGFT_UNKNOWN);
         }
 
         sb_truncate(&s->path, savepathlen);
@@ -928,20 +1225,29 @@ void wglob_search_literal_each(
     }
 }
 
-/* Adds `s->path' to `s->results'. */
+/* Adds `s->path' to `s->results'.
+ * `type' is the file type of `s->path' if known. It is trusted only if
+ * `only_if_existing' is false. */
 void wglob_add_result(
-        struct wglob_search *s, bool only_if_existing, bool markdir)
+        struct wglob_search *s, bool only_if_existing, bool markdir,
+        enum wglob_filetype_T type)
 {
     if (!only_if_existing && !markdir) {
         pl_add(s->results, xwcsdup(s->wpath.contents));
         return;
     }
 
-    struct stat st;
-    bool existing = stat(s->path.contents, &st) >= 0;
+    bool existing, isdir;
+    if (!only_if_existing && type != WGFT_UNKNOWN) {
+        existing = true, isdir = (type == WGFT_DIRECTORY);
+    } else {
+        struct stat st;
+        existing = stat(s->path.contents, &st) >= 0;
+        isdir = existing && S_ISDIR(st.st_mode);
+    }
     if (only_if_existing && !existing)
         return;
-    if (!markdir || !existing || !S_ISDIR(st.st_mode)) {
+    if (!markdir || !isdir) {
         pl_add(s->results, xwcsdup(s->wpath.contents));
         return;
     }
@@ -982,7 +1288,8 @@ void wglob_search_literal_uniq(
     for (const kvpair_T *n = names; n->key != NULL; n++) {
         const struct wglob_pattern *c = n->value;
         memset(t2->active_components, 0, s->pattern.length);
-        wglob_scandir_entry(c->value.literal.name, s, t, t2, true);
+        wglob_scandir_entry(
+                c->value.literal.name, s, t, t2, true, WGFT_UNKNOWN);
     }
 
     free(t2);
@@ -1003,13 +1310,13 @@ bool wglob_scandir(
 
     /* An empty name, which is needed for empty literal components, must be
      * explicitly produced as it would never be returned from readdir. */
-    wglob_scandir_entry("", s, t, t2, true);
+    wglob_scandir_entry("", s, t, t2, true, WGFT_UNKNOWN);
 
     /* now try each directory entry */
     struct dirent *de;
     while ((de = readdir(dir)) != NULL) {
         memset(t2->active_components, 0, s->pattern.length);
-        wglob_scandir_entry(de->d_name, s, t, t2, false);
+        wglob_scandir_entry(de->d_name, s, t, t2, false, wglob_dirent_type(de));
     }
     closedir(dir);
 
@@ -1017,17 +1324,39 @@ bool wglob_scandir(
     return true;
 }
 
+/* Returns the file type of the directory entry as reported by `readdir'.
+ * This allows us to omit `stat'ing entries that are obviously not directories.
+ */
+enum wglob_filetype_T wglob_dirent_type(const struct dirent *de)
+{
+#if HAVE_D_TYPE
+    switch (de->d_type) {
+        case DT_UNKNOWN:
+        case DT_LNK:
+            return WGFT_UNKNOWN;
+        case DT_DIR:
+            return WGFT_DIRECTORY;
+        default:
+            return WGFT_OTHER;
+    }
+#else
+    (void) de;
+    return WGFT_UNKNOWN;
+#endif
+}
+
 /* Checks if each active component matches the given `name' in the current
  * directory path and continues searching subdirectories.
  * `t' is the stack frame for the current directory path and `t2' for the next
  * frame. `t2->prev' must be `t' and `t2->active_components' must have been
  * zeroed.
  * `only_if_existing' is passed to `wglob_add_result' and should be false iff
- * the `name' is known to be an existing file. */
+ * the `name' is known to be an existing file. `type' is its file type if known.
+ */
 void wglob_scandir_entry(
         const char *name, struct wglob_search *restrict s,
         const struct wglob_stack *restrict t, struct wglob_stack *restrict t2,
-        bool only_if_existing)
+        bool only_if_existing, enum wglob_filetype_T type)
 {
     size_t savepathlen = s->path.length, savewpathlen = s->wpath.length;
 
@@ -1048,7 +1377,7 @@ void wglob_scandir_entry(
                 if (i + 1 < s->pattern.length) // has a next component?
                     t2->active_components[i + 1] = 1;
                 else
-                    wglob_add_result(s, only_if_existing, false);
+                    wglob_add_result(s, only_if_existing, false, type);
                 break;
             case WGLOB_MATCH:
                 if (name[0] == '\0')
@@ -1058,7 +1387,8 @@ void wglob_scandir_entry(
                 if (i + 1 < s->pattern.length) // has a next component?
                     t2->active_components[i + 1] = 1;
                 else
-                    wglob_add_result(s, only_if_existing, s->flags & WGLB_MARK);
+                    wglob_add_result(s, only_if_existing,
+                            s->flags & WGLB_MARK, type);
                 break;
             case WGLOB_RECSEARCH:
                 assert(i + 1 < s->pattern.length);
@@ -1067,18 +1397,20 @@ void wglob_scandir_entry(
                 if (t2->active_components[i] == 0) {
                     const char *path = s->path.contents;
                     size_t count = t->active_components[i] - 1;
-                    if (wglob_should_recurse(name, path, c, t2, count))
+                    if (wglob_should_recurse(
+                                name, path, c, t2, count, type))
                         t2->active_components[i] = t->active_components[i] + 1;
                 }
                 break;
         }
     }
 
-    sb_ccat(&s->path, '/');
-    wb_wccat(&s->wpath, L'/');
-
     /* descend down to the next subdirectory */
-    wglob_search(s, t2);
+    if (type != WGFT_OTHER) {
+        sb_ccat(&s->path, '/');
+        wb_wccat(&s->wpath, L'/');
+        wglob_search(s, t2);
+    }
 
 done:
     sb_truncate(&s->path, savepathlen);
@@ -1086,12 +1418,12 @@ done:
 }
 
 /* Decides if we should continue recursion on this component.
- * In this function, `t->st' is updated to the result of `stat'ing the `path'.
- */
+ * In this function, `t->st' is updated to the result of `stat'ing the `path'
+ * unless `type' tells that it is not a directory. */
 bool wglob_should_recurse(
         const char *restrict name, const char *restrict path,
         const struct wglob_pattern *restrict c, struct wglob_stack *restrict t,
-        size_t count)
+        size_t count, enum wglob_filetype_T type)
 {
     if (c->value.recsearch.allowperiod) {
         if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
@@ -1101,6 +1433,9 @@ bool wglob_should_recurse(
             return false;
     }
 
+    if (type == WGFT_OTHER)
+        return false;
+
     int (*statfunc)(const char *path, struct stat *st) =
         c->value.recsearch.followlink ? stat : lstat;
     if (statfunc(path, &t->st) < 0)
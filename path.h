@@ -74,9 +74,20 @@ extern void init_cmdhash(void);
 extern void clear_cmdhash(void);
 extern const char *get_command_path(const char *name, _Bool forcelookup)
     __attribute__((nonnull));
+extern char *get_command_path_uncached(const char *name)
+    __attribute__((nonnull,malloc,warn_unused_result));
 extern void fill_cmdhash(const char *prefix, _Bool ignorecase);
 extern const char *get_command_path_default(const char *name)
     __attribute__((nonnull));
+extern char *const *get_directory_commands(
+        const char *dirpath, const char *prefix)
+    __attribute__((nonnull(1)));
+extern void freeze_directory_index(_Bool freeze);
+extern char *which_indexed(
+        const char *restrict name,
+        char *const *restrict dirs,
+        _Bool cond(const char *path))
+    __attribute__((nonnull(1),malloc,warn_unused_result));
 
 
 /********** Home Directory Cache **********/
@@ -33,7 +33,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#if HAVE_MEMFD_CREATE
+# include <sys/mman.h>
+# ifndef memfd_create
+extern int memfd_create(const char *name, unsigned int flags);
+# endif
+#endif
 #if YASH_ENABLE_SOCKET
 # include <sys/socket.h>
 #endif
@@ -118,8 +123,12 @@ static void reset_shellfdmin(void);
 
 
 /* Set of file descriptors used by the shell.
- * These file descriptors cannot be used by the user. */
-static fd_set shellfds;
+ * These file descriptors cannot be used by the user.
+ * The set is a bit array that has `shellfdscount' elements. Unlike `fd_set',
+ * it can contain any file descriptor; it grows as needed. */
+static unsigned long *shellfds;
+static size_t shellfdscount;
+#define SHELLFDBITS (sizeof *shellfds * CHAR_BIT)
 /* The minimum file descriptor that can be used for shell FD. */
 static int shellfdmin;
 /* The maximum file descriptor in `shellfds'.
@@ -146,7 +155,7 @@ void init_shellfds(void)
     initialized = true;
 #endif
 
-    FD_ZERO(&shellfds);
+    assert(shellfds == NULL && shellfdscount == 0);
     reset_shellfdmin();
     assert(shellfdmax == -1);  // shellfdmax = -1;
 }
@@ -162,8 +171,6 @@ void reset_shellfdmin(void)
         else
             shellfdmin = SHELLFDMINMAX;
     } else {
-        if (shellfdmin > FD_SETSIZE)
-            shellfdmin = FD_SETSIZE;
         shellfdmin /= 2;
         if (shellfdmin > SHELLFDMINMAX)
             shellfdmin = SHELLFDMINMAX;
@@ -176,8 +183,18 @@ void reset_shellfdmin(void)
 void add_shellfd(int fd)
 {
     assert(fd >= shellfdmin);
-    if (fd < FD_SETSIZE)
-        FD_SET(fd, &shellfds);
+
+    size_t index = (size_t) fd / SHELLFDBITS;
+    if (index >= shellfdscount) {
+        size_t newcount = shellfdscount * 2;
+        if (newcount <= index)
+            newcount = index + 1;
+        shellfds = xreallocn(shellfds, newcount, sizeof *shellfds);
+        memset(&shellfds[shellfdscount], 0,
+                (newcount - shellfdscount) * sizeof *shellfds);
+        shellfdscount = newcount;
+    }
+    shellfds[index] |= 1UL << ((size_t) fd % SHELLFDBITS);
     if (shellfdmax < fd)
         shellfdmax = fd;
 }
@@ -186,21 +203,23 @@ void add_shellfd(int fd)
  * Must be called BEFORE `xclose(fd)'. */
 void remove_shellfd(int fd)
 {
-    if (0 <= fd && fd < FD_SETSIZE)
-        FD_CLR(fd, &shellfds);
+    if (!is_shellfd(fd))
+        return;
+    shellfds[(size_t) fd / SHELLFDBITS] &=
+        ~(1UL << ((size_t) fd % SHELLFDBITS));
     if (fd == shellfdmax) {
         do
             shellfdmax--;
-        while (shellfdmax >= 0 && !FD_ISSET(shellfdmax, &shellfds));
+        while (shellfdmax >= 0 && !is_shellfd(shellfdmax));
     }
 }
-/* The argument to `FD_CLR' must be a valid (open) file descriptor. This is why
- * `remove_shellfd' must be called before closing the file descriptor. */
 
 /* Checks if the specified file descriptor is in `shellfds'. */
 bool is_shellfd(int fd)
 {
-    return fd >= FD_SETSIZE || (fd >= 0 && FD_ISSET(fd, &shellfds));
+    size_t index = (size_t) fd / SHELLFDBITS;
+    return fd >= 0 && index < shellfdscount
+        && (shellfds[index] & (1UL << ((size_t) fd % SHELLFDBITS)));
 }
 
 /* Clears `shellfds'.
@@ -209,9 +228,10 @@ void clear_shellfds(bool leavefds)
 {
     if (!leavefds) {
         for (int fd = 0; fd <= shellfdmax; fd++)
-            if (FD_ISSET(fd, &shellfds))
+            if (is_shellfd(fd))
                 xclose(fd);
-        FD_ZERO(&shellfds);
+        if (shellfds != NULL)
+            memset(shellfds, 0, shellfdscount * sizeof *shellfds);
         shellfdmax = -1;
     }
     ttyfd = -1;
@@ -221,6 +241,18 @@ void clear_shellfds(bool leavefds)
  * The new FD is added to `shellfds'.
  * On error, `errno' is set and -1 is returned. */
 int copy_as_shellfd(int fd)
+{
+    int newfd = copy_as_cloexec_fd(fd, shellfdmin);
+    if (newfd >= 0)
+        add_shellfd(newfd);
+    return newfd;
+}
+
+/* Duplicates the specified file descriptor as a new FD that is not less than
+ * `minfd' and has the close-on-exec flag set. Unlike `copy_as_shellfd', the new
+ * FD is not added to `shellfds'.
+ * On error, `errno' is set and -1 is returned. */
+int copy_as_cloexec_fd(int fd, int minfd)
 {
     int newfd;
 
@@ -230,21 +262,16 @@ int copy_as_shellfd(int fd)
      * sequence if the F_DUPFD_CLOEXEC flag is rejected. */
     static bool dupfd_cloexec_ok = true;
     if (dupfd_cloexec_ok) {
-        newfd = fcntl(fd, F_DUPFD_CLOEXEC, shellfdmin);
+        newfd = fcntl(fd, F_DUPFD_CLOEXEC, minfd);
         if (newfd >= 0 || errno != EINVAL)
-            goto finish;
+            return newfd;
         dupfd_cloexec_ok = false;
     }
 #endif
 
-    newfd = fcntl(fd, F_DUPFD, shellfdmin);
+    newfd = fcntl(fd, F_DUPFD, minfd);
     if (newfd >= 0)
         fcntl(newfd, F_SETFD, FD_CLOEXEC);
-#ifdef F_DUPFD_CLOEXEC
-finish:
-#endif
-    if (newfd >= 0)
-        add_shellfd(newfd);
     return newfd;
 }
 
@@ -281,6 +308,49 @@ void open_ttyfd(void)
 }
 
 
+/********** Coprocess FDs **********/
+
+/* Array of file descriptors connected to coprocesses.
+ * Unlike shell FDs, they can be used by the user, but they are closed in
+ * subshells other than command substitutions and process redirections so that
+ * a subshell does not keep a coprocess waiting for the end of input. */
+static int *coprocfds;
+static size_t coprocfdscount, coprocfdscapacity;
+
+/* Adds the specified file descriptor to the coprocess FDs. */
+void add_coprocfd(int fd)
+{
+    assert(fd >= 0);
+    if (coprocfdscount == coprocfdscapacity) {
+        coprocfdscapacity = coprocfdscapacity * 2 + 2;
+        coprocfds = xreallocn(coprocfds, coprocfdscapacity, sizeof *coprocfds);
+    }
+    coprocfds[coprocfdscount++] = fd;
+}
+
+/* Removes the specified file descriptor from the coprocess FDs.
+ * Does nothing if the FD is not a coprocess FD. */
+void remove_coprocfd(int fd)
+{
+    for (size_t i = 0; i < coprocfdscount; i++) {
+        if (coprocfds[i] == fd) {
+            coprocfds[i] = coprocfds[--coprocfdscount];
+            return;
+        }
+    }
+}
+
+/* Clears the coprocess FDs.
+ * If `leavefds' is false, the file descriptors are closed. */
+void clear_coprocfds(bool leavefds)
+{
+    if (!leavefds)
+        for (size_t i = 0; i < coprocfdscount; i++)
+            xclose(coprocfds[i]);
+    coprocfdscount = 0;
+}
+
+
 /********** Redirections **********/
 
 /* info used to undo redirection */
@@ -304,9 +374,12 @@ static int parse_and_check_dup(char *num, redirtype_T type)
     __attribute__((nonnull));
 static int parse_and_exec_pipe(int outputfd, char *num, savefd_T **save)
     __attribute__((nonnull));
-static int open_heredocument(const struct wordunit_T *content);
+static int open_heredocument(const redir_T *r)
+    __attribute__((nonnull));
 static int open_herestring(char *s, bool appendnewline)
     __attribute__((nonnull));
+static int open_herecontents(const char *s, size_t len)
+    __attribute__((nonnull));
 static int open_process_redirection(const embedcmd_T *command, redirtype_T type)
     __attribute__((nonnull));
 
@@ -396,7 +469,7 @@ openwithflags:
         case RT_HERE:
         case RT_HERERT:
             keepopen = false;
-            fd = open_heredocument(r->rd_herecontent);
+            fd = open_heredocument(r);
             if (fd < 0)
                 return false;
             break;
@@ -747,13 +820,21 @@ error:
     goto end;
 }
 
-/* Opens a here-document whose contents is specified by the argument.
+/* Opens a here-document for the specified redirection.
  * Returns a newly opened file descriptor if successful, or -1 on error. */
-/* The contents of the here-document is passed either through a pipe or a
- * temporary file. */
-int open_heredocument(const wordunit_T *contents)
+/* If the contents does not contain any expansions, the result of the expansion
+ * and conversion is cached in `r->rd_herecache' so that it can be reused in
+ * later executions of the same redirection. The cache is invalidated when the
+ * LC_CTYPE locale is changed. */
+int open_heredocument(const redir_T *r)
 {
-    wchar_t *wcontents = expand_single(contents, TT_NONE, Q_INDQ, ES_NONE);
+    herecache_T *cache = r->rd_herecache;
+    if (cache != NULL && cache->contents != NULL
+            && cache->ctypegen == ctype_generation)
+        return open_herecontents(cache->contents, cache->length);
+
+    wchar_t *wcontents =
+        expand_single(r->rd_herecontent, TT_NONE, Q_INDQ, ES_NONE);
     if (wcontents == NULL)
         return -1;
 
@@ -764,32 +845,47 @@ int open_heredocument(const wordunit_T *contents)
         return -1;
     }
 
-    return open_herestring(mcontents, false);
+    if (cache == NULL)
+        return open_herestring(mcontents, false);
+
+    free(cache->contents);
+    cache->contents = mcontents;
+    cache->length = strlen(mcontents);
+    cache->ctypegen = ctype_generation;
+    return open_herecontents(cache->contents, cache->length);
 }
 
 /* Opens a here-string whose contents is specified by the argument.
  * If `appendnewline' is true, a newline is appended to the value of `s'.
  * Returns a newly opened file descriptor if successful, or -1 on error.
  * `s' is freed in this function. */
-/* The contents of the here-document is passed either through a pipe or a
- * temporary file. */
 int open_herestring(char *s, bool appendnewline)
+{
+    size_t len = strlen(s);
+    if (appendnewline)
+        s[len++] = '\n';
+
+    int fd = open_herecontents(s, len);
+    free(s);
+    return fd;
+}
+
+/* Opens a file descriptor from which the specified contents can be read.
+ * `s' is an array of `len' bytes, which need not be null-terminated.
+ * Returns a newly opened file descriptor if successful, or -1 on error. */
+/* The contents is passed through a pipe if it is short enough. Otherwise, it
+ * is written to an anonymous memory file if available or a temporary file. */
+int open_herecontents(const char *s, size_t len)
 {
     int fd;
 
     /* if contents is empty */
-    if (s[0] == '\0' && !appendnewline) {
+    if (len == 0) {
         fd = open("/dev/null", O_RDONLY);
-        if (fd >= 0) {
-            free(s);
+        if (fd >= 0)
             return fd;
-        }
     }
 
-    size_t len = strlen(s);
-    if (appendnewline)
-        s[len++] = '\n';
-
 #ifdef PIPE_BUF
     /* use a pipe if the contents is short enough */
     if (len <= PIPE_BUF) {
@@ -802,27 +898,36 @@ int open_herestring(char *s, bool appendnewline)
                 xerror(errno, Ngt("cannot write the here-document contents "
                             "to the temporary file"));
             xclose(pipefd[PIPE_OUT]);
-            free(s);
             return pipefd[PIPE_IN];
         }
     }
 #endif /* defined(PIPE_BUF) */
 
+#if HAVE_MEMFD_CREATE
+    /* An anonymous memory file does not need a directory entry, so it is
+     * cheaper than a temporary file. It may not be supported by the kernel, in
+     * which case we fall back on a temporary file. */
+    fd = memfd_create("yash-heredoc", 0);
+    if (fd >= 0)
+        goto write_contents;
+#endif
+
     char *tempfile;
     fd = create_temporary_file(&tempfile, "", 0);
     if (fd < 0) {
         xerror(errno,
                 Ngt("cannot create a temporary file for the here-document"));
-        free(s);
         return -1;
     }
     if (unlink(tempfile) < 0)
         xerror(errno, Ngt("failed to remove temporary file `%s'"), tempfile);
     free(tempfile);
+#if HAVE_MEMFD_CREATE
+write_contents:
+#endif
     if (!write_all(fd, s, len))
         xerror(errno, Ngt("cannot write the here-document contents "
                     "to the temporary file"));
-    free(s);
     if (lseek(fd, 0, SEEK_SET) != 0)
         xerror(errno,
                 Ngt("cannot seek the temporary file for the here-document"));
@@ -843,7 +948,7 @@ int open_process_redirection(const embedcmd_T *command, redirtype_T type)
                     "for the process redirection"));
         return -1;
     }
-    cpid = fork_and_reset(-1, false, 0);
+    cpid = fork_and_reset(-1, false, t_keepcoproc);
     if (cpid < 0) {
         /* fork failure */
         xclose(pipefd[PIPE_IN]);
@@ -906,6 +1011,8 @@ void undo_redirections(savefd_T *save)
 void clear_savefd(savefd_T *save)
 {
     while (save != NULL) {
+        /* The original FD has been permanently replaced. */
+        remove_coprocfd(save->sf_origfd);
         if (save->sf_copyfd >= 0) {
             remove_shellfd(save->sf_copyfd);
             xclose(save->sf_copyfd);
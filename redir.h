@@ -36,9 +36,14 @@ extern _Bool is_shellfd(int fd)
     __attribute__((pure));
 extern void clear_shellfds(_Bool leavefds);
 extern int copy_as_shellfd(int fd);
+extern int copy_as_cloexec_fd(int fd, int minfd);
 extern int move_to_shellfd(int fd);
 extern void open_ttyfd(void);
 
+extern void add_coprocfd(int fd);
+extern void remove_coprocfd(int fd);
+extern void clear_coprocfds(_Bool leavefds);
+
 typedef struct savefd_T savefd_T;
 struct redir_T;
 
@@ -28,7 +28,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#if HAVE_PPOLL
+# include <poll.h>
+# include <time.h>
+# ifndef ppoll
+extern int ppoll(struct pollfd *fds, nfds_t nfds,
+        const struct timespec *timeout, const sigset_t *sigmask);
+# endif
+#else
+# include <sys/select.h>
+#endif
 #include <wchar.h>
 #include <wctype.h>
 #if HAVE_GETTEXT
@@ -92,6 +101,9 @@ static void handle_sigchld(void);
 static void set_trap(int signum, const wchar_t *command);
 static bool is_originally_ignored(int signum);
 static void banish_phantoms(void);
+static int wait_for_fds(size_t count, const int fds[], bool ready[],
+        const struct timespec *timeout, const sigset_t *sigmask)
+    __attribute__((nonnull(2,3,5)));
 #if YASH_ENABLE_LINEEDIT
 # ifdef SIGWINCH
 static inline void handle_sigwinch(void);
@@ -382,6 +394,20 @@ void restore_signals(bool leave)
     }
 }
 
+/* Returns the signal mask for a command that is executed without forking the
+ * shell, that is, by `posix_spawn'. The spawned program has the default
+ * handler for every signal caught by the shell and inherits every signal
+ * ignored by the shell. If that differs from what `restore_signals(true)' would
+ * do in a forked child, the result is NULL. */
+const sigset_t *get_sigmask_for_exec(void)
+{
+    if (job_handlers_set || interactive_handlers_set)
+        return NULL;
+    if (sigismember(&officially_ignored_signals, SIGCHLD))
+        return NULL;
+    return &official_sigmask;
+}
+
 /* Re-sets the signal handler for SIGTTIN, SIGTTOU, and SIGTSTP according to the
  * current `doing_job_control_now' and `job_handlers_set'. */
 void reset_job_signals(void)
@@ -615,6 +641,17 @@ int wait_for_sigchld(bool interruptible, bool return_on_trap)
 }
 
 /* Waits for the specified file descriptor to be available for reading.
+ * This function is equivalent to `wait_for_inputs' for one file descriptor. */
+enum wait_for_input_T wait_for_input(int fd, bool trap, int timeout)
+{
+    bool ready;
+    return wait_for_inputs(1, &fd, &ready, trap, timeout);
+}
+
+/* Waits for any of the specified file descriptors to be available for
+ * reading.
+ * `fds' is an array of `count' file descriptors. When this function returns
+ * W_READY, `ready[i]' is set to true iff `fds[i]' is available.
  * `handle_sigchld' and `handle_sigwinch' are called to handle SIGCHLD and
  * SIGWINCH that are caught while waiting.
  * If `trap' is true, traps are also handled while waiting and the
@@ -626,17 +663,22 @@ int wait_for_sigchld(bool interruptible, bool return_on_trap)
  * If the wait is interrupted by a signal, this function will re-wait for the
  * specified timeout, which means that this function may wait for a time length
  * longer than the specified timeout. */
-enum wait_for_input_T wait_for_input(int fd, bool trap, int timeout)
+enum wait_for_input_T wait_for_inputs(
+        size_t count, const int fds[], bool ready[], bool trap, int timeout)
 {
     sigset_t ss;
     struct timespec to;
     struct timespec *top;
 
-    assert(fd >= 0);
-    if (fd >= FD_SETSIZE) {
-        xerror(0, Ngt("too many files are opened for yash to handle"));
-        return W_ERROR;
+#if !HAVE_PPOLL
+    for (size_t i = 0; i < count; i++) {
+        assert(fds[i] >= 0);
+        if (fds[i] >= FD_SETSIZE) {
+            xerror(0, Ngt("too many files are opened for yash to handle"));
+            return W_ERROR;
+        }
     }
+#endif
 
     if (trap)
         sigint_received = false;
@@ -670,27 +712,145 @@ enum wait_for_input_T wait_for_input(int fd, bool trap, int timeout)
             return W_INTERRUPTED;
         }
 
-        fd_set fdset;
-        FD_ZERO(&fdset);
-        FD_SET(fd, &fdset);
-
-        int count = pselect(fd + 1, &fdset, NULL, NULL, top, &ss);
+        int readycount = wait_for_fds(count, fds, ready, top, &ss);
 
         if (trap && sigint_received) {
             sigint_received = false;
             return W_INTERRUPTED;
         }
 
-        if (count >= 0)
-            return FD_ISSET(fd, &fdset) ? W_READY : W_TIMED_OUT;
+        if (readycount >= 0)
+            return readycount > 0 ? W_READY : W_TIMED_OUT;
 
         if (errno != EINTR) {
+#if HAVE_PPOLL
+            xerror(errno, "ppoll");
+#else
             xerror(errno, "pselect");
+#endif
             return W_ERROR;
         }
     }
 }
 
+/* Waits for any of the specified file descriptors to be available for reading
+ * while the signal mask is temporarily replaced with `sigmask'.
+ * Returns the number of available file descriptors, zero on timeout, or -1 on
+ * error with `errno' set. `ready' is set as described in `wait_for_inputs'. */
+int wait_for_fds(size_t count, const int fds[], bool ready[],
+        const struct timespec *timeout, const sigset_t *sigmask)
+{
+#if HAVE_PPOLL
+    /* `ppoll' accepts any file descriptor, unlike `pselect', which is limited
+     * to FD_SETSIZE. */
+    struct pollfd onepfd, *pfds;
+    pfds = (count == 1) ? &onepfd : xmallocn(count, sizeof *pfds);
+    for (size_t i = 0; i < count; i++) {
+        assert(fds[i] >= 0);
+        pfds[i] = (struct pollfd) { .fd = fds[i], .events = POLLIN, };
+    }
+
+    int result = ppoll(pfds, count, timeout, sigmask);
+    if (result > 0)
+        /* A hung-up or invalid file descriptor is reported as available so
+         * that the following read reports end-of-file or the error, as it does
+         * after `pselect'. */
+        for (size_t i = 0; i < count; i++)
+            ready[i] = (pfds[i].revents
+                    & (POLLIN | POLLHUP | POLLERR | POLLNVAL)) != 0;
+
+    if (pfds != &onepfd) {
+        int saveerrno = errno;
+        free(pfds);
+        errno = saveerrno;
+    }
+    return result;
+#else /* !HAVE_PPOLL */
+    fd_set fdset;
+    int maxfd = -1;
+    FD_ZERO(&fdset);
+    for (size_t i = 0; i < count; i++) {
+        FD_SET(fds[i], &fdset);
+        if (maxfd < fds[i])
+            maxfd = fds[i];
+    }
+
+    int result = pselect(maxfd + 1, &fdset, NULL, NULL, timeout, sigmask);
+    if (result > 0)
+        for (size_t i = 0; i < count; i++)
+            ready[i] = FD_ISSET(fds[i], &fdset);
+    return result;
+#endif /* HAVE_PPOLL */
+}
+
+/* Waits for any of the specified file descriptors to be available for reading
+ * or for SIGCHLD to be caught, whichever comes first, and then calls
+ * `handle_sigchld'.
+ * `fds' is an array of `count' file descriptors. `ready[i]' is set to true iff
+ * `fds[i]' is available.
+ * If `interruptible' is true, this function can be canceled by SIGINT.
+ * If `return_on_trap' is true, this function returns immediately after a trap
+ * is handled. Otherwise, traps are not handled.
+ * The maximum time length of wait is specified by `timeout' in milliseconds.
+ * If `timeout' is negative, the wait time is unlimited.
+ * Returns the signal number if interrupted, -1 on error, or zero otherwise. */
+int wait_for_inputs_or_sigchld(size_t count, const int fds[], bool ready[],
+        int timeout, bool interruptible, bool return_on_trap)
+{
+    int result = 0;
+    struct timespec to;
+    struct timespec *top;
+
+    for (size_t i = 0; i < count; i++) {
+        ready[i] = false;
+#if !HAVE_PPOLL
+        assert(fds[i] >= 0);
+        if (fds[i] >= FD_SETSIZE) {
+            xerror(0, Ngt("too many files are opened for yash to handle"));
+            return -1;
+        }
+#endif
+    }
+
+    sigset_t ss = accept_sigmask;
+    sigdelset(&ss, SIGCHLD);
+    if (interruptible)
+        sigdelset(&ss, SIGINT);
+
+    if (timeout < 0) {
+        top = NULL;
+    } else {
+        to.tv_sec  = timeout / 1000;
+        to.tv_nsec = timeout % 1000 * 1000000;
+        top = &to;
+    }
+
+    for (;;) {
+        if (return_on_trap && ((result = handle_traps()) != 0))
+            break;
+        if (interruptible && sigint_received)
+            break;
+        if (sigchld_received)
+            break;
+        if (wait_for_fds(count, fds, ready, top, &ss) >= 0)
+            break;
+        if (errno != EINTR) {
+#if HAVE_PPOLL
+            xerror(errno, "ppoll");
+#else
+            xerror(errno, "pselect");
+#endif
+            result = -1;
+            break;
+        }
+    }
+
+    if (interruptible && sigint_received)
+        result = SIGINT;
+    handle_sigchld();
+    return result;
+}
+
 /* Handles SIGCHLD if caught. */
 void handle_sigchld(void)
 {
@@ -19,6 +19,7 @@
 #ifndef YASH_SIG_H
 #define YASH_SIG_H
 
+#include <signal.h>
 #include <stddef.h>
 #include <sys/types.h>
 #include "xgetopt.h"
@@ -37,6 +38,8 @@ extern _Bool any_trap_set;
 extern void init_signal(void);
 extern void set_signals(void);
 extern void restore_signals(_Bool leave);
+extern const sigset_t *get_sigmask_for_exec(void)
+    __attribute__((pure));
 extern void reset_job_signals(void);
 extern void set_interruptible_by_sigint(_Bool onoff);
 extern void ignore_sigquit_and_sigint(void);
@@ -51,6 +54,12 @@ enum wait_for_input_T {
 };
 
 extern enum wait_for_input_T wait_for_input(int fd, _Bool trap, int timeout);
+extern enum wait_for_input_T wait_for_inputs(size_t count,
+        const int fds[], _Bool ready[], _Bool trap, int timeout)
+    __attribute__((nonnull));
+extern int wait_for_inputs_or_sigchld(size_t count, const int fds[],
+        _Bool ready[], int timeout, _Bool interruptible, _Bool return_on_trap)
+    __attribute__((nonnull));
 
 extern int handle_traps(void);
 extern void execute_exit_trap(void);
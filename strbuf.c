@@ -41,6 +41,32 @@ size_t wcsnrtombs(char *restrict dst, const wchar_t **restrict src, size_t nwc,
  * the return value is the argument buffer. */
 
 
+/* True if the current locale's character encoding is stateless and encodes
+ * every ASCII character as a single byte of the same value. Wide and multibyte
+ * strings consisting of ASCII characters only can be converted to each other
+ * by simply copying the values in such a locale, which is the case for UTF-8
+ * and most other encodings in use. */
+static bool ascii_compatible = false;
+
+/* Incremented whenever the LC_CTYPE category is changed so that multibyte
+ * strings converted in the old locale can be detected. */
+unsigned long ctype_generation = 0;
+
+/* Updates the `ascii_compatible' flag for the current locale.
+ * This function must be called whenever the LC_CTYPE category is changed. */
+void update_ascii_compatibility(void)
+{
+    ctype_generation++;
+    ascii_compatible = false;
+    if (mblen(NULL, 0) != 0)
+        return;  /* state-dependent encoding */
+    for (int c = 1; c < 0x80; c++)
+        if (btowc(c) != (wint_t) c || wctob((wint_t) c) != c)
+            return;
+    ascii_compatible = true;
+}
+
+
 /********** Multibyte String Buffer **********/
 
 /* Initializes the specified string buffer as an empty string. */
@@ -188,6 +214,23 @@ bool sb_wccat(xstrbuf_T *restrict buf, wchar_t c, mbstate_t *restrict ps)
 wchar_t *sb_wcsncat(xstrbuf_T *restrict buf,
         const wchar_t *restrict s, size_t n, mbstate_t *restrict ps)
 {
+    if (ascii_compatible && mbsinit(ps)) {
+        /* copy the leading ASCII characters without conversion */
+        size_t i = 0;
+        while (i < n && 0 < s[i] && s[i] < 0x80)
+            i++;
+        if (i > 0) {
+            sb_ensuremax(buf, add(buf->length, i));
+            for (size_t j = 0; j < i; j++)
+                buf->contents[buf->length + j] = (char) s[j];
+            buf->length += i;
+            buf->contents[buf->length] = '\0';
+            s += i, n -= i;
+        }
+        if (n == 0 || *s == L'\0')
+            return NULL;
+    }
+
 #if HAVE_WCSNRTOMBS
     for (;;) {
         const wchar_t *saves = s;
@@ -234,6 +277,23 @@ wchar_t *sb_wcsncat(xstrbuf_T *restrict buf,
 wchar_t *sb_wcscat(xstrbuf_T *restrict buf,
         const wchar_t *restrict s, mbstate_t *restrict ps)
 {
+    if (ascii_compatible && mbsinit(ps)) {
+        /* copy the leading ASCII characters without conversion */
+        size_t i = 0;
+        while (0 < s[i] && s[i] < 0x80)
+            i++;
+        if (i > 0) {
+            sb_ensuremax(buf, add(buf->length, i));
+            for (size_t j = 0; j < i; j++)
+                buf->contents[buf->length + j] = (char) s[j];
+            buf->length += i;
+            buf->contents[buf->length] = '\0';
+            s += i;
+        }
+        if (*s == L'\0')
+            return NULL;
+    }
+
     for (;;) {
         size_t count = wcsrtombs(&buf->contents[buf->length],
                 (const wchar_t **) &s,
@@ -420,6 +480,23 @@ char *wb_mbscat(xwcsbuf_T *restrict buf, const char *restrict s)
     mbstate_t state;
     size_t count;
 
+    if (ascii_compatible) {
+        /* copy the leading ASCII characters without conversion */
+        size_t i = 0;
+        while (0 < (unsigned char) s[i] && (unsigned char) s[i] < 0x80)
+            i++;
+        if (i > 0) {
+            wb_ensuremax(buf, add(buf->length, i));
+            for (size_t j = 0; j < i; j++)
+                buf->contents[buf->length + j] = (wchar_t) s[j];
+            buf->length += i;
+            buf->contents[buf->length] = L'\0';
+            s += i;
+        }
+        if (*s == '\0')
+            return NULL;
+    }
+
     memset(&state, 0, sizeof state);  // initialize as the initial shift state
 
     for (;;) {
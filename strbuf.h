@@ -42,6 +42,9 @@ typedef struct xwcsbuf_T {
     size_t length, maxlength;
 } xwcsbuf_T;
 
+extern unsigned long ctype_generation;
+extern void update_ascii_compatibility(void);
+
 static inline xstrbuf_T *sb_init(xstrbuf_T *buf)
     __attribute__((nonnull));
 extern xstrbuf_T *sb_initwith(xstrbuf_T *restrict buf, char *restrict s)
@@ -0,0 +1,136 @@
+# cat-y.tst: yash-specific test of the cat built-in
+
+if ! testee -c 'command -bv cat' >/dev/null; then
+    skip="true"
+fi
+
+test_oE 'copying files in order'
+echo foo > file1
+echo bar > file2
+cat file1 file2 file1
+__IN__
+foo
+bar
+foo
+__OUT__
+
+test_oE 'copying standard input without operand'
+cat <<END
+foo
+bar
+END
+__IN__
+foo
+bar
+__OUT__
+
+test_oE 'copying standard input specified by hyphen'
+echo foo > file1
+echo bar | cat file1 - file1
+__IN__
+foo
+bar
+foo
+__OUT__
+
+test_oE 'copying empty file'
+: > empty
+cat empty
+echo $?
+__IN__
+0
+__OUT__
+
+test_oE 'copying file to file'
+awk 'BEGIN { for (i = 1; i <= 3000; i++) print i }' > file1
+cat file1 > file2
+cmp file1 file2 && echo ok
+__IN__
+ok
+__OUT__
+
+test_oE 'appending file to file'
+echo foo > file1
+echo bar > file2
+cat file2 >> file1
+cat file1
+__IN__
+foo
+bar
+__OUT__
+
+test_oE 'copying from pipe to pipe'
+awk 'BEGIN { for (i = 1; i <= 30000; i++) print i }' | cat | cat > file1
+awk 'BEGIN { for (i = 1; i <= 30000; i++) print i }' | cmp - file1 && echo ok
+__IN__
+ok
+__OUT__
+
+test_oE 'reading continues from current file offset'
+printf '%s\n' 1 2 3 > file1
+{ read -r x; cat; } < file1
+__IN__
+2
+3
+__OUT__
+
+test_oE 'subsequent command reads after copied contents'
+printf '%s\n' 1 2 > file1
+{ cat; echo $?; cat; echo $?; } < file1
+__IN__
+1
+2
+0
+0
+__OUT__
+
+test_oE 'output of preceding built-in comes first'
+echo foo > file1
+{ printf 'a'; echo b; cat file1; echo c; } > file2
+cat file2
+__IN__
+ab
+foo
+c
+__OUT__
+
+test_oE -e 0 'option -u'
+echo foo | cat -u
+__IN__
+foo
+__OUT__
+
+test_Oe -e 1 'non-existent file'
+cat ./_no_such_file_
+__IN__
+cat: cannot open file `./_no_such_file_': No such file or directory
+__ERR__
+#'
+#`
+
+test_x -e 1 'exit status with non-existent file among others'
+echo foo > file1
+cat file1 ./_no_such_file_ file1 2>/dev/null
+__IN__
+
+test_oE 'file after non-existent file is copied'
+echo foo > file1
+cat ./_no_such_file_ file1 2>/dev/null
+__IN__
+foo
+__OUT__
+
+test_Oe -e 2 'invalid option'
+cat --no-such-option
+__IN__
+cat: `--no-such-option' is not a valid option
+__ERR__
+#'
+#`
+
+test_O -d -e 1 'printing to closed stream'
+echo foo > file1
+cat file1 >&-
+__IN__
+
+# vim: set ft=sh ts=8 sts=4 sw=4 et:
@@ -10,9 +10,9 @@ foo
 __OUT__
 
 test_Oe -e 127 'external command is not found with -b option'
-command -b cat /dev/null
+command -b wc /dev/null
 __IN__
-command: no such command `cat'
+command: no such command `wc'
 __ERR__
 #`
 
@@ -140,7 +140,7 @@ __IN__
 )
 
 test_OE -e 0 'describing external command (-V)'
-command -V cat | grep -q '^cat: an external command at'
+command -V wc | grep -q '^wc: an external command at'
 __IN__
 
 test_oE -e 0 'describing function (-V)'
@@ -247,7 +247,7 @@ command -va exit
 __IN__
 
 test_OE -e 1 'describing non-existent command (-vb)'
-command -vb cat
+command -vb wc
 __IN__
 
 test_OE -e 1 'describing non-existent command (-ve)'
@@ -23,4 +23,48 @@ __IN__
 complete: the complete built-in can be used during command line completion only
 __ERR__
 
+(
+if ! ../ptwrap -i true </dev/null 2>/dev/null; then
+    skip="true"
+fi
+
+mkdir dir
+>dir/zzfile
+
+# Keys are fed to an interactive shell running in a pseudo-terminal and the
+# completed command line is checked by its result.
+test_oE 'completing file name after parameter expansion'
+export VD=dir
+{
+    printf '%s\t>>out\n' 'echo $VD/zz' 'echo ${VD}/zz'
+    echo exit
+} |
+TERM=vt100 ../ptwrap -i "$TESTEE" -i +m --norcfile >/dev/null 2>&1
+cat out
+__IN__
+dir/zzfile
+dir/zzfile
+__OUT__
+
+test_oE 'completing command name added after last completion'
+mkdir bin
+echo 'echo "${0##*/}"' >bin/zzcmd1
+chmod a+x bin/zzcmd1
+touch -t 200001010000 bin
+export PATH="$PWD/bin:$PATH"
+{
+    printf '%s\t>>out2\n' 'zzcm'
+    echo 'mv bin/zzcmd1 bin/zzcmd2'
+    printf '%s\t>>out2\n' 'zzcm'
+    echo exit
+} |
+TERM=vt100 ../ptwrap -i "$TESTEE" -i +m --norcfile >/dev/null 2>&1
+cat out2
+__IN__
+zzcmd1
+zzcmd2
+__OUT__
+
+)
+
 # vim: set ft=sh ts=8 sts=4 sw=4 et:
@@ -0,0 +1,139 @@
+# coproc-y.tst: yash-specific test of the coproc built-in
+
+test_oE 'coprocess reads from and writes to the shell'
+coproc cat
+echo foo >&"${COPROC[2]}"
+read -r line <&"${COPROC[1]}"
+echo "$line"
+echo bar >&"${COPROC[2]}"
+read -r line <&"${COPROC[1]}"
+echo "$line"
+__IN__
+foo
+bar
+__OUT__
+
+test_oE 'file descriptors are assigned to array'
+coproc cat
+echo "${COPROC[#]}"
+[ "${COPROC[1]}" -ge 10 ] && [ "${COPROC[2]}" -ge 10 ] && echo ok
+__IN__
+2
+ok
+__OUT__
+
+test_oE 'array name can be specified (-v)'
+coproc -v p cat
+coproc --variable=q cat
+echo "${p[#]}" "${q[#]}"
+[ "${p[1]}" != "${q[1]}" ] && echo ok
+__IN__
+2 2
+ok
+__OUT__
+
+test_oE 'coprocess is a job'
+coproc exit 7
+wait $!
+echo $?
+__IN__
+7
+__OUT__
+
+test_oE 'coprocess sees end of input when file descriptor is closed'
+coproc -v c sort
+printf '%s\n' 3 1 2 >&"${c[2]}"
+eval "exec ${c[2]}>&-"
+cat <&"${c[1]}"
+wait %
+echo $?
+__IN__
+1
+2
+3
+0
+__OUT__
+
+test_oE 'function as coprocess'
+f() { while read -r line; do echo "[$line]"; done; }
+coproc f
+echo foo >&"${COPROC[2]}"
+read -r line <&"${COPROC[1]}"
+echo "$line"
+__IN__
+[foo]
+__OUT__
+
+test_oE 'file descriptors are not inherited by external commands'
+coproc cat
+ls /dev/fd/ | grep -Fqx "${COPROC[1]}" || echo ok
+__IN__
+ok
+__OUT__
+
+test_oE 'file descriptors are not available in subshells'
+coproc cat
+(: >&"${COPROC[2]}") 2>/dev/null || echo closed
+: >&"${COPROC[2]}" && echo open
+__IN__
+closed
+open
+__OUT__
+
+test_oE 'file descriptors are not available in asynchronous commands'
+coproc cat
+{ : >&"${COPROC[2]}"; } 2>/dev/null &
+wait $!
+[ $? -ne 0 ] && echo closed
+__IN__
+closed
+__OUT__
+
+test_oE 'file descriptors are available in command substitutions'
+coproc cat
+x=$(echo foo >&"${COPROC[2]}"; read -r line <&"${COPROC[1]}"; echo "$line")
+echo "$x"
+__IN__
+foo
+__OUT__
+
+test_oE 'file descriptors are available in process redirections'
+coproc cat
+echo bar >&"${COPROC[2]}"
+cat <(read -r line <&"${COPROC[1]}"; echo "$line")
+__IN__
+bar
+__OUT__
+
+test_oE 'options after command are passed to command'
+coproc cat -u
+echo foo >&"${COPROC[2]}"
+read -r line <&"${COPROC[1]}"
+echo "$line"
+__IN__
+foo
+__OUT__
+
+test_Oe -e 2 'missing operand'
+coproc
+__IN__
+coproc: this command requires an operand
+__ERR__
+
+test_Oe -e 2 'invalid variable name'
+coproc -v = cat
+__IN__
+coproc: `=' is not a valid variable name
+__ERR__
+#'
+#`
+
+test_Oe -e 2 'invalid option --xxx'
+coproc --no-such=option
+__IN__
+coproc: `--no-such=option' is not a valid option
+__ERR__
+#'
+#`
+
+# vim: set ft=sh ts=8 sts=4 sw=4 et:
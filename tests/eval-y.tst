@@ -57,6 +57,54 @@ foo
 foobar
 __OUT__
 
+test_oE -e 0 'same code evaluated repeatedly'
+i=0
+while [ $i -lt 3 ]; do
+    eval 'echo $i; i=$((i+1))'
+done
+eval 'echo $i'
+__IN__
+0
+1
+2
+3
+__OUT__
+
+test_oE -e 0 'alias redefinition affects re-evaluated code'
+alias a='echo 1'
+eval a
+alias a='echo 2'
+eval a
+unalias a
+a() { echo 3; }
+eval a
+__IN__
+1
+2
+3
+__OUT__
+
+test_oE -e 0 'alias defined in re-evaluated multi-line code'
+eval 'alias b="echo x"
+b y'
+unalias b
+eval 'alias b="echo x"
+b y'
+__IN__
+x y
+x y
+__OUT__
+
+test_oE -e 0 'code redefining itself while being evaluated'
+f='echo $n; n=$((n+1)); [ $n -lt 3 ] && eval "$f"; alias x=y'
+n=0
+eval "$f"
+__IN__
+0
+1
+2
+__OUT__
+
 test_Oe -e n 'invalid option'
 eval --no-such-option
 __IN__
@@ -25,14 +25,15 @@ g0='' g1='--disable-printf'
 h0='' h1='--disable-socket'
 i0='' i1='--disable-ulimit'
 j0='' j1='--debug'
+k0='' k1='--enable-cat'
 
-do_test $a0 $b0 $c0 $d0 $e1 $f1 $g0 $h1 $i0 $j0 "$@"
-do_test $a0 $b1 $c1 $d1 $e1 $f0 $g1 $h0 $i1 $j1 "$@"
-do_test $a0 $b2 $c0 $d1 $e0 $f0 $g1 $h1 $i0 $j1 "$@"
-do_test $a1 $b0 $c0 $d0 $e0 $f0 $g1 $h1 $i1 $j1 "$@"
-do_test $a1 $b1 $c1 $d0 $e1 $f0 $g0 $h0 $i1 $j0 "$@"
-do_test $a1 $b2 $c1 $d1 $e1 $f1 $g1 $h0 $i0 $j0 "$@"
-do_test $a2 $b0 $c1 $d1 $e0 $f1 $g1 $h0 $i1 $j0 "$@"
-do_test $a2 $b1 $c0 $d1 $e0 $f1 $g1 $h1 $i0 $j1 "$@"
-do_test $a2 $b2 $c0 $d1 $e0 $f0 $g0 $h0 $i1 $j1 "$@"
-do_test $a2 $b2 $c1 $d0 $e1 $f0 $g1 $h1 $i0 $j0 "$@"
+do_test $a0 $b0 $c0 $d0 $e1 $f1 $g0 $h1 $i0 $j0 $k1 "$@"
+do_test $a0 $b1 $c1 $d1 $e1 $f0 $g1 $h0 $i1 $j1 $k0 "$@"
+do_test $a0 $b2 $c0 $d1 $e0 $f0 $g1 $h1 $i0 $j1 $k1 "$@"
+do_test $a1 $b0 $c0 $d0 $e0 $f0 $g1 $h1 $i1 $j1 $k0 "$@"
+do_test $a1 $b1 $c1 $d0 $e1 $f0 $g0 $h0 $i1 $j0 $k1 "$@"
+do_test $a1 $b2 $c1 $d1 $e1 $f1 $g1 $h0 $i0 $j0 $k0 "$@"
+do_test $a2 $b0 $c1 $d1 $e0 $f1 $g1 $h0 $i1 $j0 $k1 "$@"
+do_test $a2 $b1 $c0 $d1 $e0 $f1 $g1 $h1 $i0 $j1 $k0 "$@"
+do_test $a2 $b2 $c0 $d1 $e0 $f0 $g0 $h0 $i1 $j1 $k1 "$@"
+do_test $a2 $b2 $c1 $d0 $e1 $f0 $g1 $h1 $i0 $j0 $k0 "$@"
@@ -158,4 +158,18 @@ __IN__
 bar
 __OUT__
 
+test_oE 'function defined or removed between calls from the same command'
+for i in 1 2 3; do
+    echo $i
+    case $i in
+        1) echo() { command echo function "$@"; } ;;
+        2) unset -f echo ;;
+    esac
+done
+__IN__
+1
+function 2
+3
+__OUT__
+
 # vim: set ft=sh ts=8 sts=4 sw=4 et:
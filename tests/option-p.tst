@@ -119,8 +119,8 @@ printf '%s\n' "$-" | grep -qv h
 __IN__
 
 test_oE 'hashondef (short) on: effect' -h
-h_option_test() { cat /dev/null; }
-echo $(hash | grep '/cat$' | wc -l)
+h_option_test() { wc /dev/null; }
+echo $(hash | grep '/wc$' | wc -l)
 __IN__
 1
 __OUT__
@@ -51,4 +51,52 @@ syntax error: ksh-like extended glob pattern `!(...)' is not supported
 __ERR__
 #`
 
+test_oE 'external commands in pipeline'
+printf '%s\n' b a c | sort | head -n 2
+__IN__
+a
+b
+__OUT__
+
+test_oE 'script without shebang in pipeline'
+echo 'echo in script; cat' > script
+chmod a+x script
+echo foo | ./script | cat
+__IN__
+in script
+foo
+__OUT__
+
+test_oE 'exit status of non-executable file in pipeline' -o pipefail
+: > nonexec
+chmod a-x nonexec
+./nonexec 2>/dev/null | cat
+echo $?
+__IN__
+126
+__OUT__
+
+test_oE 'commands in pipeline are not remembered in hashtable'
+hash -r
+echo | cat | cat >/dev/null
+hash
+__IN__
+__OUT__
+
+test_oE 'trapped signal is reset to default in command in pipeline' \
+    -o pipefail
+trap 'echo trapped' USR1
+sh -c 'kill -s USR1 $$' | cat
+kill -l $?
+__IN__
+USR1
+__OUT__
+
+test_oE 'ignored signal is ignored in command in pipeline'
+trap '' USR1
+sh -c 'kill -s USR1 $$; echo alive' | cat
+__IN__
+alive
+__OUT__
+
 # vim: set ft=sh ts=8 sts=4 sw=4 et:
@@ -132,7 +132,12 @@ static void process_buffer(
     }
 }
 
-static void forward_all_io(int master_fd) {
+static void forward_all_io(int master_fd, bool forward_input) {
+    struct channel_T incoming;
+    incoming.from_fd = STDIN_FILENO;
+    incoming.to_fd = master_fd;
+    incoming.state = forward_input ? READING : INACTIVE;
+
     struct channel_T outgoing;
     outgoing.from_fd = master_fd;
     outgoing.to_fd = STDOUT_FILENO;
@@ -145,11 +150,13 @@ static void forward_all_io(int master_fd) {
         fd_set read_fds, write_fds;
         FD_ZERO(&read_fds);
         FD_ZERO(&write_fds);
+        set_fd_set(&incoming, &read_fds, &write_fds);
         set_fd_set(&outgoing, &read_fds, &write_fds);
         if (select(master_fd + 1, &read_fds, &write_fds, NULL, NULL) < 0)
             errno_exit("cannot find file descriptor to forward");
 
         /* read to or write from buffer */
+        process_buffer(&incoming, &read_fds, &write_fds);
         process_buffer(&outgoing, &read_fds, &write_fds);
     }
 }
@@ -219,7 +226,13 @@ int main(int argc, char *argv[]) {
     if (getopt(argc, argv, "") != -1)
         exit(EXIT_FAILURE);
     */
+    /* The -i option makes the standard input forwarded to the slave. */
+    bool forward_input = false;
     optind = 1;
+    if (optind < argc && strcmp(argv[optind], "-i") == 0) {
+        forward_input = true;
+        optind++;
+    }
     if (optind < argc && strcmp(argv[optind], "--") == 0)
         optind++;
 
@@ -236,7 +249,7 @@ int main(int argc, char *argv[]) {
     if (child_pid > 0) {
         /* parent process */
         close(slave_fd);
-        forward_all_io(master_fd);
+        forward_all_io(master_fd, forward_input);
         return await_child(child_pid);
     } else {
         /* child process */
@@ -211,6 +211,24 @@ foo
 foo
 __OUT__
 
+test_oE -e 0 'constant here-document executed repeatedly'
+for i in 1 2 3; do
+    cat <<\END
+$i\
+END
+    cat <<END
+\$i
+END
+done
+__IN__
+$i\
+$i
+$i\
+$i
+$i\
+$i
+__OUT__
+
 test_oE -e 0 'duplicating input to the same file descriptor'
 echo foo | cat <&0
 __IN__
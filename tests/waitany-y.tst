@@ -0,0 +1,149 @@
+# waitany-y.tst: yash-specific test of the waitany built-in
+
+mkfifo fifo
+
+test_oE 'file descriptor that is ready is printed'
+exec 3<(sleep 1; echo a) 4<(echo b)
+waitany 3 4
+__IN__
+4
+__OUT__
+
+test_oE 'file descriptor at end of file is ready'
+exec 3</dev/null
+waitany 3
+__IN__
+3
+__OUT__
+
+test_oE 'all ready operands are printed in order'
+exec 3</dev/null 4</dev/null
+waitany 4 3
+__IN__
+4
+3
+__OUT__
+
+test_oE 'waiting until file descriptor becomes ready'
+exec 3<(cat fifo)
+waitany -t 0 3
+echo $?
+echo foo >fifo
+waitany 3
+read -r line <&3
+echo "$line"
+__IN__
+1
+3
+foo
+__OUT__
+
+test_oE 'terminated job is ready'
+exit 3 &
+waitany %
+wait %
+echo $?
+__IN__
+%
+3
+__OUT__
+
+test_oE 'running job is not ready'
+cat fifo &
+waitany -t 0 %
+echo $?
+>fifo
+waitany %1
+__IN__
+1
+%1
+__OUT__
+
+test_oE 'mixture of file descriptors and jobs'
+exec 3<(cat fifo)
+exit &
+waitany -t 5 3 %
+__IN__
+%
+__OUT__
+
+test_oE 'ready operands are assigned to array (-v)'
+exec 3</dev/null 4</dev/null
+waitany -v ready 3 4
+echo $? "${ready[#]}" "$ready"
+__IN__
+0 2 3 4
+__OUT__
+
+test_oE 'array is not modified on timeout'
+exec 3<(cat fifo)
+ready=(foo)
+waitany --timeout=0.1 --variable=ready 3
+echo $? "$ready"
+>fifo
+__IN__
+1 foo
+__OUT__
+
+test_oE 'trap interrupts waiting'
+trap 'echo trapped' USR1
+exec 3<(cat fifo)
+(sleep 0.1; kill -USR1 $$) &
+waitany 3
+status=$?
+echo $((status > 128))
+kill -l $status
+>fifo
+__IN__
+trapped
+1
+USR1
+__OUT__
+
+test_Oe -e 2 'missing operand'
+waitany
+__IN__
+waitany: this command requires an operand
+__ERR__
+
+test_Oe -e 2 'invalid file descriptor'
+waitany X
+__IN__
+waitany: `X' is not a valid integer
+__ERR__
+#'
+#`
+
+test_Oe -e 2 'no such job'
+waitany %100
+__IN__
+waitany: no such job `%100'
+__ERR__
+#'
+#`
+
+test_Oe -e 2 'invalid timeout'
+waitany -t X 0
+__IN__
+waitany: `X' is not a valid number
+__ERR__
+#'
+#`
+
+test_Oe -e 2 'invalid variable name'
+waitany -v = 0
+__IN__
+waitany: `=' is not a valid variable name
+__ERR__
+#'
+#`
+
+test_Oe -e 2 'invalid option --xxx'
+waitany --no-such=option
+__IN__
+waitany: `--no-such=option' is not a valid option
+__ERR__
+#'
+#`
+
+# vim: set ft=sh ts=8 sts=4 sw=4 et:
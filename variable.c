@@ -134,6 +134,9 @@ static void init_pwd(void);
 
 static variable_T *search_variable(const wchar_t *name)
     __attribute__((pure,nonnull));
+static variable_T *search_variable_with_hash(
+        const wchar_t *name, hashval_T hash)
+    __attribute__((pure,nonnull));
 static variable_T *search_array_and_check_if_changeable(const wchar_t *name)
     __attribute__((pure,nonnull));
 static void update_environment(const wchar_t *name)
@@ -142,13 +145,14 @@ static void reset_locale(const wchar_t *name)
     __attribute__((nonnull));
 static void reset_locale_category(const wchar_t *name, int category)
     __attribute__((nonnull));
-static variable_T *new_global(const wchar_t *name)
+static variable_T *new_global(const wchar_t *name, hashval_T hash)
     __attribute__((nonnull));
-static variable_T *new_local(const wchar_t *name)
+static variable_T *new_local(const wchar_t *name, hashval_T hash)
     __attribute__((nonnull));
-static variable_T *new_temporary(const wchar_t *name)
+static variable_T *new_temporary(const wchar_t *name, hashval_T hash)
     __attribute__((nonnull));
-static variable_T *new_variable(const wchar_t *name, scope_T scope)
+static variable_T *new_variable(
+        const wchar_t *name, hashval_T hash, scope_T scope)
     __attribute__((nonnull));
 static void xtrace_variable(const wchar_t *name, const wchar_t *value)
     __attribute__((nonnull));
@@ -196,6 +200,11 @@ static bool random_active;
 /* hashtable from function names (wchar_t *) to functions (function_T *). */
 static hashtable_T functions;
 
+/* This counter is incremented each time a function is defined or removed.
+ * A function body found by a previous search is valid only while this counter
+ * is unchanged. */
+unsigned long function_generation = 0;
+
 
 /* Frees the value of the specified variable (but not the variable itself). */
 /* This function does not change the value of `*v'. */
@@ -287,7 +296,8 @@ void init_variables(void)
 
     /* set $LINENO */
     {
-        variable_T *v = new_variable(L VAR_LINENO, SCOPE_GLOBAL);
+        variable_T *v =
+            new_variable(L VAR_LINENO, hashwcs(L VAR_LINENO), SCOPE_GLOBAL);
         assert(v != NULL);
         v->v_type = VF_SCALAR | (v->v_type & VF_EXPORT);
         v->v_value = NULL;
@@ -314,7 +324,7 @@ void init_variables(void)
 
     /* export $OLDPWD */
     {
-        variable_T *v = new_global(L VAR_OLDPWD);
+        variable_T *v = new_global(L VAR_OLDPWD, hashwcs(L VAR_OLDPWD));
         assert(v != NULL);
         v->v_type |= VF_EXPORT;
         variable_set(L VAR_OLDPWD, v);
@@ -329,7 +339,8 @@ void init_variables(void)
 
     /* set $RANDOM */
     if (!posixly_correct) {
-        variable_T *v = new_variable(L VAR_RANDOM, SCOPE_GLOBAL);
+        variable_T *v =
+            new_variable(L VAR_RANDOM, hashwcs(L VAR_RANDOM), SCOPE_GLOBAL);
         assert(v != NULL);
         v->v_type = VF_SCALAR;
         v->v_value = NULL;
@@ -384,9 +395,17 @@ set:
 /* Searches for a variable with the specified name.
  * Returns NULL if none was found. */
 variable_T *search_variable(const wchar_t *name)
+{
+    return search_variable_with_hash(name, hashwcs(name));
+}
+
+/* Same as `search_variable', but `hash' must be the value of `hashwcs(name)'.
+ * The hash value is computed only once however many environments are
+ * searched. */
+variable_T *search_variable_with_hash(const wchar_t *name, hashval_T hash)
 {
     for (environ_T *env = current_env; env != NULL; env = env->parent) {
-        variable_T *var = ht_get(&env->contents, name).value;
+        variable_T *var = ht_getwcswithhash(&env->contents, name, hash).value;
         if (var != NULL)
             return var;
     }
@@ -436,7 +455,7 @@ void update_environment(const wchar_t *name)
 char *get_exported_value(const wchar_t *name)
 {
     for (environ_T *env = current_env; env != NULL; env = env->parent) {
-        const variable_T *var = ht_get(&env->contents, name).value;
+        const variable_T *var = ht_getwcs(&env->contents, name).value;
         if (var != NULL && (var->v_type & VF_EXPORT)) {
             switch (var->v_type & VF_MASK) {
                 case VF_SCALAR:
@@ -505,6 +524,8 @@ void reset_locale_category(const wchar_t *name, int category)
     char *wlocale = malloc_wcstombs(locale);
     if (wlocale != NULL) {
         setlocale(category, wlocale);
+        if (category == LC_CTYPE)
+            update_ascii_compatibility();
         free(wlocale);
     }
 }
@@ -513,11 +534,11 @@ void reset_locale_category(const wchar_t *name, int category)
  * If the variable already exists, it is returned without change. So the return
  * value may be an array variable or it may be a scalar variable with a value.
  * Temporary variables with the `name' are cleared if any. */
-variable_T *new_global(const wchar_t *name)
+variable_T *new_global(const wchar_t *name, hashval_T hash)
 {
     variable_T *var;
     for (environ_T *env = current_env; env != NULL; env = env->parent) {
-        var = ht_get(&env->contents, name).value;
+        var = ht_getwcswithhash(&env->contents, name, hash).value;
         if (var != NULL) {
             if (env->is_temporary) {
                 assert(!(var->v_type & VF_NODELETE));
@@ -539,14 +560,14 @@ variable_T *new_global(const wchar_t *name)
  * If the variable already exists, it is returned without change. So the return
  * value may be an array variable or it may be a scalar variable with a value.
  * Temporary variables with the `name' are cleared if any. */
-variable_T *new_local(const wchar_t *name)
+variable_T *new_local(const wchar_t *name, hashval_T hash)
 {
     environ_T *env = current_env;
     while (env->is_temporary) {
         varkvfree_reexport(ht_remove(&env->contents, name));
         env = env->parent;
     }
-    variable_T *var = ht_get(&env->contents, name).value;
+    variable_T *var = ht_getwcswithhash(&env->contents, name, hash).value;
     if (var != NULL)
         return var;
     var = xmalloc(sizeof *var);
@@ -563,17 +584,17 @@ variable_T *new_local(const wchar_t *name)
  * The current environment must be a temporary environment.
  * If there is a read-only non-temporary variable with the specified name, it is
  * returned (no new temporary variable is created). */
-variable_T *new_temporary(const wchar_t *name)
+variable_T *new_temporary(const wchar_t *name, hashval_T hash)
 {
     environ_T *env = current_env;
     assert(env->is_temporary);
 
     /* check if read-only */
-    variable_T *var = search_variable(name);
+    variable_T *var = search_variable_with_hash(name, hash);
     if (var != NULL && (var->v_type & VF_READONLY))
         return var;
 
-    var = ht_get(&env->contents, name).value;
+    var = ht_getwcswithhash(&env->contents, name, hash).value;
     if (var != NULL)
         return var;
     var = xmalloc(sizeof *var);
@@ -585,6 +606,7 @@ variable_T *new_temporary(const wchar_t *name)
 }
 
 /* Creates a new variable with the specified name if there is none.
+ * `hash' must be the value of `hashwcs(name)'.
  * If the variable already exists, it is cleared and returned.
  *
  * On error, an error message is printed to the standard error and NULL is
@@ -593,14 +615,14 @@ variable_T *new_temporary(const wchar_t *name)
  * members of the variable (including `v_type') must be initialized by the
  * caller. If `v_type' of the return value includes the VF_EXPORT flag, the
  * caller must call `update_environment'. */
-variable_T *new_variable(const wchar_t *name, scope_T scope)
+variable_T *new_variable(const wchar_t *name, hashval_T hash, scope_T scope)
 {
     variable_T *var;
 
     switch (scope) {
-        case SCOPE_GLOBAL:  var = new_global(name);     break;
-        case SCOPE_LOCAL:   var = new_local(name);      break;
-        case SCOPE_TEMP:    var = new_temporary(name);  break;
+        case SCOPE_GLOBAL:  var = new_global(name, hash);     break;
+        case SCOPE_LOCAL:   var = new_local(name, hash);      break;
+        case SCOPE_TEMP:    var = new_temporary(name, hash);  break;
         default:            assert(false);
     }
     if (var->v_type & VF_READONLY) {
@@ -623,11 +645,18 @@ variable_T *new_variable(const wchar_t *name, scope_T scope)
  * standard error. */
 bool set_variable(
         const wchar_t *name, wchar_t *value, scope_T scope, bool export)
+{
+    return set_variable_with_hash(name, hashwcs(name), value, scope, export);
+}
+
+/* Same as `set_variable', but `hash' must be the value of `hashwcs(name)'. */
+bool set_variable_with_hash(const wchar_t *name, hashval_T hash,
+        wchar_t *value, scope_T scope, bool export)
 {
     if (shopt_allexport && name[0] != '=')
         export = true;
 
-    variable_T *var = new_variable(name, scope);
+    variable_T *var = new_variable(name, hash, scope);
     if (var == NULL) {
         free(value);
         return false;
@@ -664,7 +693,7 @@ variable_T *set_array(const wchar_t *name, size_t count, void **values,
     if (shopt_allexport && name[0] != '=')
         export = true;
 
-    variable_T *var = new_variable(name, scope);
+    variable_T *var = new_variable(name, hashwcs(name), scope);
     if (var == NULL) {
         plfree(values, free);
         return NULL;
@@ -755,7 +784,8 @@ bool do_assignments(const assign_T *assign, bool temp, bool export)
                     return false;
                 if (shopt_xtrace)
                     xtrace_variable(assign->a_name, value);
-                if (!set_variable(assign->a_name, value, scope, export))
+                if (!set_variable_with_hash(assign->a_name,
+                            assign->a_namehash, value, scope, export))
                     return false;
                 break;
             case A_ARRAY:
@@ -837,6 +867,13 @@ const wchar_t *getvar(const wchar_t *name)
  * caller must not modify the array or its elements.
  * `count' is the number of elements in `values'. */
 struct get_variable_T get_variable(const wchar_t *name)
+{
+    return get_variable_with_hash(name, hashwcs(name));
+}
+
+/* Same as `get_variable', but `hash' must be the value of `hashwcs(name)'. */
+struct get_variable_T get_variable_with_hash(
+        const wchar_t *name, hashval_T hash)
 {
     struct get_variable_T result;
     wchar_t *value;
@@ -898,7 +935,7 @@ positional_parameters:
     }
 
     /* now it should be a normal variable */
-    var = search_variable(name);
+    var = search_variable_with_hash(name, hash);
     if (var != NULL) {
         if (var->v_getter)
             var->v_getter(var);
@@ -1196,7 +1233,7 @@ void reset_path(path_T name, variable_T *var)
     for (environ_T *env = current_env; env != NULL; env = env->parent) {
         plfree((void **) env->paths[name], free);
 
-        variable_T *v = ht_get(&env->contents, path_variables[name]).value;
+        variable_T *v = ht_getwcs(&env->contents, path_variables[name]).value;
         if (v != NULL) {
             switch (v->v_type & VF_MASK) {
                 case VF_SCALAR:
@@ -1255,7 +1292,7 @@ void funckvfree(kvpair_T kv)
  * Returns true iff successful. */
 bool define_function(const wchar_t *name, command_T *body)
 {
-    function_T *f = ht_get(&functions, name).value;
+    function_T *f = ht_getwcs(&functions, name).value;
     if (f != NULL && (f->f_type & VF_READONLY)) {
         xerror(0, Ngt("function `%ls' cannot be redefined "
                     "because it is read-only"), name);
@@ -1268,6 +1305,7 @@ bool define_function(const wchar_t *name, command_T *body)
     if (shopt_hashondef)
         hash_all_commands_recursively(body);
     funckvfree(ht_set(&functions, xwcsdup(name), f));
+    function_generation++;
     return true;
 }
 
@@ -1275,7 +1313,7 @@ bool define_function(const wchar_t *name, command_T *body)
  * Returns NULL if there is no such a function. */
 command_T *get_function(const wchar_t *name)
 {
-    function_T *f = ht_get(&functions, name).value;
+    function_T *f = ht_getwcs(&functions, name).value;
     if (f != NULL)
         return f->f_body;
     else
@@ -1741,7 +1779,9 @@ int typeset_builtin(int argc, void **argv)
                     *wequal = L'\0';
                 if (wequal != NULL || !print) {
                     /* create/assign variable */
-                    variable_T *var = global ? new_global(arg) : new_local(arg);
+                    hashval_T hash = hashwcs(arg);
+                    variable_T *var = global ?
+                        new_global(arg, hash) : new_local(arg, hash);
                     vartype_T saveexport = var->v_type & VF_EXPORT;
                     if (wequal != NULL) {
                         if (var->v_type & VF_READONLY) {
@@ -1774,7 +1814,7 @@ int typeset_builtin(int argc, void **argv)
                 }
             } else {
                 /* treat function */
-                function_T *f = ht_get(&functions, arg).value;
+                function_T *f = ht_getwcs(&functions, arg).value;
                 if (f != NULL) {
                     if (print) {
                         if (!readonly || (f->f_type & VF_READONLY))
@@ -2346,6 +2386,7 @@ bool unset_function(const wchar_t *name)
     if (f != NULL) {
         if (!(f->f_type & VF_NODELETE)) {
             funckvfree(kv);
+            function_generation++;
         } else {
             xerror(0, Ngt("function `%ls' is read-only"), name);
             ht_set(&functions, kv.key, kv.value);
@@ -2786,11 +2827,13 @@ int read_builtin(int argc, void **argv)
     plist_T list;
     pl_init(&list);
     {
-        const wchar_t *ifs = getvar(L VAR_IFS);
-        if (ifs == NULL)
-            ifs = DEFAULT_IFS;
+        const wchar_t *ifschars = getvar(L VAR_IFS);
+        if (ifschars == NULL)
+            ifschars = DEFAULT_IFS;
 
-        tail = extract_fields(buf.contents, cc.contents, ifs, &list);
+        ifs_T ifs;
+        tail = extract_fields(buf.contents, cc.contents,
+                init_ifs(&ifs, ifschars), &list);
         assert(list.length % 2 == 0);
     }
 
@@ -20,6 +20,7 @@
 #define YASH_VARIABLE_H
 
 #include <stddef.h>
+#include "hashtable.h"
 #include "xgetopt.h"
 
 
@@ -30,6 +31,7 @@ extern char **environ;
 #define VAR_COLUMNS                   "COLUMNS"
 #define VAR_COMMAND                   "COMMAND"
 #define VAR_COMMAND_NOT_FOUND_HANDLER "COMMAND_NOT_FOUND_HANDLER"
+#define VAR_COPROC                    "COPROC"
 #define VAR_DIRSTACK                  "DIRSTACK"
 #define VAR_ECHO_STYLE                "ECHO_STYLE"
 #define VAR_ENV                       "ENV"
@@ -70,6 +72,7 @@ extern char **environ;
 #define VAR_TERM                      "TERM"
 #define VAR_WORDS                     "WORDS"
 #define VAR_YASH_AFTER_CD             "YASH_AFTER_CD"
+#define VAR_YASH_LE_COMPCACHE_TIMEOUT "YASH_LE_COMPCACHE_TIMEOUT"
 #define VAR_YASH_LE_TIMEOUT           "YASH_LE_TIMEOUT"
 #define VAR_YASH_LOADPATH             "YASH_LOADPATH"
 #define VAR_YASH_VERSION              "YASH_VERSION"
@@ -96,6 +99,9 @@ typedef enum scope_T {
 extern _Bool set_variable(
         const wchar_t *name, wchar_t *value, scope_T scope, _Bool export)
     __attribute__((nonnull(1)));
+extern _Bool set_variable_with_hash(const wchar_t *name, hashval_T hash,
+        wchar_t *value, scope_T scope, _Bool export)
+    __attribute__((nonnull(1)));
 extern struct variable_T *set_array(
         const wchar_t *name, size_t count, void **values,
         scope_T scope, _Bool export)
@@ -118,6 +124,9 @@ extern const wchar_t *getvar(const wchar_t *name)
     __attribute__((pure,nonnull));
 extern struct get_variable_T get_variable(const wchar_t *name)
     __attribute__((nonnull,warn_unused_result));
+extern struct get_variable_T get_variable_with_hash(
+        const wchar_t *name, hashval_T hash)
+    __attribute__((nonnull,warn_unused_result));
 extern void save_get_variable_values(struct get_variable_T *gv)
     __attribute__((nonnull));
 
@@ -130,6 +139,8 @@ extern char **decompose_paths(const wchar_t *paths)
     __attribute__((malloc,warn_unused_result));
 extern char *const *get_path_array(path_T name);
 
+extern unsigned long function_generation;
+
 extern _Bool define_function(const wchar_t *name, struct command_T *body)
     __attribute__((nonnull));
 extern struct command_T *get_function(const wchar_t *name)
@@ -99,6 +99,7 @@ int main(int argc, char **argv)
     setvbuf(stderr, NULL, _IOLBF, BUFSIZ);
 
     setlocale(LC_ALL, "");
+    update_ascii_compatibility();
 #if HAVE_GETTEXT
     bindtextdomain(PACKAGE_NAME, LOCALEDIR);
     textdomain(PACKAGE_NAME);